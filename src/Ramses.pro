@@ -74,6 +74,7 @@ SOURCES += \
     duqf-widgets/dutreewidget.cpp \
     duqf-widgets/settingswidget.cpp \
     progressmanager.cpp \
+    rameditwidgets/objecteditsession.cpp \
     rameditwidgets/objectupdateblocker.cpp \
     rameditwidgets/scheduleentryeditwidget.cpp \
     rameditwidgets/scheduleroweditwidget.cpp \
@@ -128,8 +129,11 @@ SOURCES += \
     duqf-widgets/duqfupdatedialog.cpp \
     ramdatainterface/datacrypto.cpp \
     ramdatainterface/localdatainterface.cpp \
+    ramdatainterface/localdataworker.cpp \
     ramdatainterface/logindialog.cpp \
+    ramdatainterface/pullreplyreader.cpp \
     ramdatainterface/ramserverinterface.cpp \
+    ramdatainterface/tablerowcodec.cpp \
     rameditwidgets/applicationeditwidget.cpp \
     rammanagerwidgets/applicationmanagerwidget.cpp \
     rameditwidgets/asseteditwidget.cpp \
@@ -159,6 +163,7 @@ SOURCES += \
     ramfilemetadatamanager.cpp \
     ramnamemanager.cpp \
     ramobjects/ramabstractobject.cpp \
+    ramobjects/ramobjectregistry.cpp \
     ramobjects/ramassetgroup.cpp \
     ramobjects/rampipefile.cpp \
     ramobjects/ramsequence.cpp \
@@ -166,6 +171,7 @@ SOURCES += \
     ramobjects/ramtemplatestep.cpp \
     ramobjects/ramworkingfolder.cpp \
     ramdatainterface/dbinterface.cpp \
+    ramdatainterface/dbwritebatch.cpp \
     duqf-nodeview/duqfconnection.cpp \
     duqf-nodeview/duqfconnectionmanager.cpp \
     duqf-nodeview/duqfconnector.cpp \
@@ -271,6 +277,7 @@ HEADERS += \
     pch/duwidgets_pch.h \
     progressmanager.h \
     ramdatainterface/datastruct.h \
+    rameditwidgets/objecteditsession.h \
     rameditwidgets/objectupdateblocker.h \
     rameditwidgets/scheduleentryeditwidget.h \
     rameditwidgets/scheduleroweditwidget.h \
@@ -328,8 +335,11 @@ HEADERS += \
     progressbar.h \
     progresspage.h \
     ramdatainterface/localdatainterface.h \
+    ramdatainterface/localdataworker.h \
     ramdatainterface/logindialog.h \
+    ramdatainterface/pullreplyreader.h \
     ramdatainterface/ramserverinterface.h \
+    ramdatainterface/tablerowcodec.h \
     rameditwidgets/applicationeditwidget.h \
     rammanagerwidgets/applicationmanagerwidget.h \
     rameditwidgets/asseteditwidget.h \
@@ -358,6 +368,8 @@ HEADERS += \
     ramfilemetadatamanager.h \
     ramnamemanager.h \
     ramobjects/ramabstractobject.h \
+    ramobjects/ramobjectregistry.h \
+    ramobjects/ramfield.h \
     ramobjects/ramassetgroup.h \
     ramobjects/rampipefile.h \
     ramobjects/ramsequence.h \
@@ -365,6 +377,7 @@ HEADERS += \
     ramobjects/ramtemplatestep.h \
     ramobjects/ramworkingfolder.h \
     ramdatainterface/dbinterface.h \
+    ramdatainterface/dbwritebatch.h \
     duqf-app/app-version.h \
     duqf-nodeview/duqfconnection.h \
     duqf-nodeview/duqfconnectionmanager.h \
@@ -4,6 +4,7 @@
 #include "duqf-app/duui.h"
 #include "duqf-widgets/duqfupdatedialog.h"
 #include "daemon.h"
+#include "ramdatainterface/dbinterface.h"
 
 SettingsDock::SettingsDock(QWidget *parent)
     : DuScrollArea{parent}
@@ -38,6 +39,7 @@ void SettingsDock::setupUi()
     setupAppearanceTab();
     setupUpdatesTab();
     setupDaemonTab();
+    setupDatabaseTab();
 
     mainLayout->addStretch();
     this->setWidget(dummy);
@@ -165,6 +167,62 @@ void SettingsDock::setupDaemonTab()
     l->addStretch();
 }
 
+void SettingsDock::setupDatabaseTab()
+{
+    QWidget *w = addTab(DuIcon(":/icons/storage-settings"), "Database");
+
+    auto dbLabel = new QLabel("<b>" + tr("Local database:") + "</b>", w);
+    w->layout()->addWidget( dbLabel );
+
+    auto dbWidget = new QWidget(w);
+    dbWidget->setProperty("class", "duBlock");
+    w->layout()->addWidget(dbWidget);
+
+    auto dbLayout = new QFormLayout(dbWidget);
+    DuUI::setupLayout(dbLayout, 3);
+
+    ui_storageProfileBox = new DuComboBox(dbWidget);
+    ui_storageProfileBox->addItem(tr("Compatible"), CompatibleStorage);
+    ui_storageProfileBox->addItem(tr("Balanced"), BalancedStorage);
+    ui_storageProfileBox->addItem(tr("Performance"), PerformanceStorage);
+    ui_storageProfileBox->setItemData(0, tr("Default SQLite settings.\nThe safest, but the slowest."), Qt::ToolTipRole);
+    ui_storageProfileBox->setItemData(1, tr("Write-ahead log, memory-mapped I/O and a bigger cache."), Qt::ToolTipRole);
+    ui_storageProfileBox->setItemData(2, tr("Like balanced, using more memory.\nFor large databases."), Qt::ToolTipRole);
+    ui_storageProfileBox->setCurrentData( _sm->dbStorageProfile() );
+
+    dbLayout->addRow(tr("Storage profile"), ui_storageProfileBox);
+
+    auto noteLabel = new QLabel(tr("Databases on network drives always use the compatible profile."), dbWidget);
+    noteLabel->setWordWrap(true);
+    dbLayout->addRow(noteLabel);
+
+    auto syncLabel = new QLabel("<b>" + tr("Server sync:") + "</b>", w);
+    w->layout()->addWidget( syncLabel );
+
+    auto syncWidget = new QWidget(w);
+    syncWidget->setProperty("class", "duBlock");
+    w->layout()->addWidget(syncWidget);
+
+    auto syncLayout = new QFormLayout(syncWidget);
+    DuUI::setupLayout(syncLayout, 3);
+
+    ui_lastSyncLabel = new QLabel("-", syncWidget);
+    syncLayout->addRow(tr("Last sync"), ui_lastSyncLabel);
+
+    ui_syncDurationLabel = new QLabel("-", syncWidget);
+    syncLayout->addRow(tr("Duration"), ui_syncDurationLabel);
+
+    ui_syncRowsLabel = new QLabel("-", syncWidget);
+    syncLayout->addRow(tr("Rows"), ui_syncRowsLabel);
+
+    ui_nextSyncLabel = new QLabel("-", syncWidget);
+    ui_nextSyncLabel->setWordWrap(true);
+    syncLayout->addRow(tr("Next sync"), ui_nextSyncLabel);
+
+    auto l = qobject_cast<QVBoxLayout*>( w->layout() );
+    l->addStretch();
+}
+
 void SettingsDock::connectEvents()
 {
     connect( ui_toolButtonStyleBox, QOverload<int>::of(&DuComboBox::activated),
@@ -210,6 +268,35 @@ void SettingsDock::connectEvents()
         _sm->setDaemonPort(ui_daemonPortBox->value());
     });
     connect( ui_restartDaemonButton, &QPushButton::clicked, Daemon::instance(), &Daemon::restart );
+
+    connect( ui_storageProfileBox, &DuComboBox::dataActivated, this, [this] (const QVariant p) {
+        _sm->setDBStorageProfile( static_cast<StorageProfile>(p.toInt()) );
+    });
+    connect(_sm, &DuSettingsManager::dbStorageProfileChanged,
+            ui_storageProfileBox, &DuComboBox::setCurrentData);
+
+    connect(DBInterface::instance(), &DBInterface::syncScheduled, this, &SettingsDock::updateSyncStats);
+}
+
+void SettingsDock::updateSyncStats()
+{
+    DBInterface *dbi = DBInterface::instance();
+    const SyncStats &stats = dbi->lastSyncStats();
+    if (!stats.start.isValid()) return;
+
+    QString lastSync = stats.start.toLocalTime().toString(_sm->uiDateFormat());
+    if (stats.withError) lastSync += " " + tr("(failed)");
+    ui_lastSyncLabel->setText(lastSync);
+
+    ui_syncDurationLabel->setText(tr("%1 s").arg(stats.duration / 1000.0, 0, 'f', 1));
+
+    ui_syncRowsLabel->setText(tr("%1 pushed, %2 pulled, %3 deleted").arg(
+                                  QString::number(stats.pushedRows),
+                                  QString::number(stats.pulledRows),
+                                  QString::number(stats.deletedRows)
+                                  ));
+
+    ui_nextSyncLabel->setText(dbi->nextSync().toString(_sm->uiDateFormat()) + "\n" + dbi->nextSyncReason());
 }
 
 QWidget *SettingsDock::addTab(const DuIcon &icon, const QString &name)
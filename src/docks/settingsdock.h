@@ -19,7 +19,10 @@ private:
     void setupAppearanceTab();
     void setupUpdatesTab();
     void setupDaemonTab();
+    void setupDatabaseTab();
     void connectEvents();
+    // Shows the stats of the last sync and the next scheduled sync
+    void updateSyncStats();
 
     // Widgets
     DuTabWidget *ui_tabWidget;
@@ -37,6 +40,13 @@ private:
     DuSpinBox *ui_daemonPortBox;
     QPushButton *ui_restartDaemonButton;
 
+    DuComboBox *ui_storageProfileBox;
+
+    QLabel *ui_lastSyncLabel;
+    QLabel *ui_syncDurationLabel;
+    QLabel *ui_syncRowsLabel;
+    QLabel *ui_nextSyncLabel;
+
     // Shortcut
     DuSettingsManager *_sm;
 
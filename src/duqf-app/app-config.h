@@ -5,6 +5,10 @@
 #define ENCRYPT_USER_DATA true
 #define CACHE_RAMOBJECT_DATA true
 #define CACHE_LOCAL_DATA true
+// Max size of the local data read cache, in characters
+#define LOCAL_DATA_CACHE_SIZE 16000000
+// How long a connection waits for the other one to release the database, in ms
+#define DB_BUSY_TIMEOUT 30000
 #define DATETIME_DATA_FORMAT "yyyy-MM-dd hh:mm:ss"
 #define DATE_DATA_FORMAT "yyyy-MM-dd"
 
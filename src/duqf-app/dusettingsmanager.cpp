@@ -12,6 +12,7 @@ const QString DuSettingsManager::UI_DOCK_SIZE = QStringLiteral("UI/dockSize/");
 const QString DuSettingsManager::UI_DATE_FORMAT = QStringLiteral("UI/dateFomat");
 const QString DuSettingsManager::CHECK_UPDATES = QStringLiteral("checkUpdates");
 const QString DuSettingsManager::DAEMON_PORT = QStringLiteral("daemonPort");
+const QString DuSettingsManager::DB_STORAGE_PROFILE = QStringLiteral("DB/storageProfile");
 
 DuSettingsManager *DuSettingsManager::_instance = nullptr;
 
@@ -194,6 +195,19 @@ void DuSettingsManager::setDaemonPort(int p) {
     m_settings.setValue(DAEMON_PORT, p);
 }
 
+StorageProfile DuSettingsManager::dbStorageProfile() const
+{
+    return static_cast<StorageProfile>(
+        m_settings.value(DB_STORAGE_PROFILE, BalancedStorage).toInt()
+        );
+}
+
+void DuSettingsManager::setDBStorageProfile(StorageProfile p)
+{
+    m_settings.setValue(DB_STORAGE_PROFILE, p);
+    emit dbStorageProfileChanged(p);
+}
+
 DuSettingsManager::DuSettingsManager(QObject *parent)
     : QObject{parent}
 {
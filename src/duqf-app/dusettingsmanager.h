@@ -20,6 +20,7 @@ public:
     static const QString UI_DATE_FORMAT;
     static const QString CHECK_UPDATES;
     static const QString DAEMON_PORT;
+    static const QString DB_STORAGE_PROFILE;
 
     static DuSettingsManager *instance();
 
@@ -52,6 +53,7 @@ public:
     QString uiDateFormat() const;
     bool checkUpdates() const;
     int daemonPort() const;
+    StorageProfile dbStorageProfile() const;
 
 public slots:
     void setUIFocusColor(const QColor &color);
@@ -77,6 +79,7 @@ public slots:
     void setUIDateFormat(const QString f);
     void setCheckUpdates(bool c);
     void setDaemonPort(int p);
+    void setDBStorageProfile(StorageProfile p);
 
 signals:
     void nvCurvatureChanged(float);
@@ -87,6 +90,7 @@ signals:
     void trayIconColorChanged(QColor);
     void trayIconVisibilityChanged(bool);
     void uiDateFormatChanged(QString);
+    void dbStorageProfileChanged(StorageProfile);
 
 protected:
     static DuSettingsManager *_instance;
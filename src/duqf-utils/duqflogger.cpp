@@ -49,7 +49,7 @@ void DuQFLogger::log(DuQFLog message)
 
 DuQFLogger::DuQFLogger(QObject *parent) : QObject(parent)
 {
-
+    qRegisterMetaType<DuQFLog>("DuQFLog");
 }
 
 // === Log
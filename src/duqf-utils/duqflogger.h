@@ -38,6 +38,9 @@ private:
     QString _time;
 };
 
+// Logs may come from other threads
+Q_DECLARE_METATYPE(DuQFLog)
+
 class DuQFLoggerObject: public QObject
 {
     Q_OBJECT
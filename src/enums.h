@@ -7,6 +7,12 @@ enum ColorVariant {
     LighterColor
 };
 
+enum StorageProfile {
+    CompatibleStorage, // Default SQLite settings (rollback journal)
+    BalancedStorage, // WAL journal, memory-mapped I/O and a bigger cache
+    PerformanceStorage // Same as balanced, with larger cache, mmap and checkpoints
+};
+
 enum LogType {
     DataLog = -1,
     DebugLog = 0,
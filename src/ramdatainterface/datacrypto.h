@@ -7,6 +7,8 @@ class DataCrypto
 {
 public:
     static DataCrypto *instance();
+    // instance() is for the main thread, other threads use their own instance
+    DataCrypto();
 
     QString clientEncrypt(QString data);
     QString machineEncrypt(QString data);
@@ -26,8 +28,6 @@ protected:
     static DataCrypto* _instance;
 
 private:
-    DataCrypto();
-
     quint64 m_clientKey;
     quint64 m_machineKey;
 };
@@ -30,6 +30,46 @@ struct SyncData
     QHash<QString, QSet<TableRow>> tables;
     QHash<QString, QStringList> deletedUuids;
     QString syncDate;
+    // When true, the rows are not in the tables, they've been saved in the staging tables of the local database
+    bool staged = false;
+    // The last local journal entry pushed with this sync, removed once the sync is saved
+    qint64 changeId = 0;
+};
+
+struct SyncStats
+{
+    QDateTime start;
+    // Milliseconds
+    qint64 duration = 0;
+    int pushedRows = 0;
+    int pulledRows = 0;
+    int deletedRows = 0;
+    // Milliseconds, when the server has asked to wait with a Retry-After header
+    int retryAfter = 0;
+    bool withError = false;
+};
+
+struct TableDescriptor
+{
+    QString name;
+    QStringList columns;
+    // The user table has a userName column
+    bool hasUserName = false;
+    // The JSON keys of the data which have an indexed generated column
+    QStringList jsonKeys;
+};
+
+struct TableChange
+{
+    // InsertedRemoved (a new row which is already removed) and Deleted (a row deleted from the table)
+    // only update the uuid index, they're not emitted
+    enum Type { Inserted, DataChanged, Removed, AvailabilityChanged, InsertedRemoved, Deleted };
+    Type type;
+    QString uuid;
+    QString data;
+    QString modified;
+    QString table;
+    bool available = true;
 };
 
 struct TableFetchData
@@ -40,6 +80,16 @@ struct TableFetchData
     int deleteCount = 0;
     bool pulled = false;
     int currentPage = 0;
+    // What the pages depend on: the date the changes are fetched from,
+    // and the state of the table on the server (its last modification date, or a checksum)
+    QString previousSyncDate;
+    QString fingerprint;
+};
+
+struct PulledPage
+{
+    QSet<TableRow> rows;
+    QStringList deletedUuids;
 };
 
 struct FetchData
@@ -68,4 +118,6 @@ inline uint qHash(const TableRow &a)
     return qHash(a.uuid);
 }
 
+Q_DECLARE_METATYPE(TableChange)
+
 #endif // DATASTRUCT_H
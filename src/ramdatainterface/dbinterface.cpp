@@ -3,6 +3,8 @@
 #include "progressmanager.h"
 #include "statemanager.h"
 
+#include <QRandomGenerator>
+
 DBInterface *DBInterface::_instance = nullptr;
 
 DBInterface *DBInterface::instance()
@@ -67,7 +69,7 @@ QSet<QString> DBInterface::tableUuids(QString table)
     return m_ldi->tableUuids(table);
 }
 
-bool DBInterface::contains(QString uuid, QString table, bool includeRemoved)
+bool DBInterface::contains(const QString &uuid, const QString &table, bool includeRemoved)
 {
     return m_ldi->contains(uuid, table, includeRemoved);
 }
@@ -88,29 +90,50 @@ void DBInterface::setObjectData(QString uuid, QString table, QString data)
 }
 
 QString DBInterface::validateObjectData(QString data, QString uuid, QString type, bool ignoreErrors)
+{
+    QString error;
+    QString validData = validateJsonData(data, &error);
+    if (validData != "" || ignoreErrors) return validData;
+
+    // Everything failed
+
+    QString eStr = "";
+    if (uuid != "") eStr = "Object with uuid: " + uuid + " contains invalid data.\n";
+    else eStr = "An unknown object contains invalid data.\n";
+    eStr += "This data will be removed, sorry.";
+    if (type != "") eStr += "Object type: " + type + "\n";
+    eStr += "Parse error: " + error + "\n";
+    eStr += "Original data:\n" + data;
+
+    // Log the error
+    log(eStr, DuQFLog::Warning);
+
+    return "{}";
+}
+
+QString DBInterface::validateJsonData(const QString &data, QString *errorString)
 {
     if (data == "") return "{}";
     // Try to create a JSON Doc
-    QJsonParseError *e = new QJsonParseError();
-    QJsonDocument doc = QJsonDocument::fromJson(data.toUtf8(), e);
+    QJsonParseError e;
+    QJsonDocument doc = QJsonDocument::fromJson(data.toUtf8(), &e);
 
     // OK, return a compact json
-    if (e->error == QJsonParseError::NoError) return doc.toJson(QJsonDocument::Compact);
+    if (e.error == QJsonParseError::NoError) return doc.toJson(QJsonDocument::Compact);
 
-    if (ignoreErrors) return "";
+    if (errorString) *errorString = e.errorString();
 
     // Try some fixes
-    QString testData = data;
 
     // A common error lies with new lines. Try to fix.
     // Remove carriage returns, to accept only new lines
+    QString testData = data;
     testData.replace("\r", "");
     // Try escaping new lines
     testData.replace("\n","\\n");
-    // Test again
-    testData = validateObjectData(testData, uuid, type, true);
+    doc = QJsonDocument::fromJson(testData.toUtf8(), &e);
     // It worked
-    if (testData != "") return testData;
+    if (e.error == QJsonParseError::NoError) return doc.toJson(QJsonDocument::Compact);
 
     // Another attempt at fixing new lines
     testData = data;
@@ -118,25 +141,11 @@ QString DBInterface::validateObjectData(QString data, QString uuid, QString type
     testData.replace("\r", "");
     // Try removing new lines
     testData.replace("\n","");
-    // Test again
-    testData = validateObjectData(testData, uuid, type, true);
+    doc = QJsonDocument::fromJson(testData.toUtf8(), &e);
     // It worked
-    if (testData != "") return testData;
-
-    // Everything failed
-
-    QString eStr = "";
-    if (uuid != "") eStr = "Object with uuid: " + uuid + " contains invalid data.\n";
-    else eStr = "An unknown object contains invalid data.\n";
-    eStr += "This data will be removed, sorry.";
-    if (type != "") eStr += "Object type: " + type + "\n";
-    eStr += "Parse error: " + e->errorString() + "\n";
-    eStr += "Original data:\n" + data;
-
-    // Log the error
-    log(eStr, DuQFLog::Warning);
+    if (e.error == QJsonParseError::NoError) return doc.toJson(QJsonDocument::Compact);
 
-    return "{}";
+    return "";
 }
 
 void DBInterface::removeObject(QString uuid, QString table)
@@ -171,6 +180,16 @@ bool DBInterface::isUserNameAavailable(const QString &userName)
     return m_ldi->isUserNameAavailable(userName);
 }
 
+void DBInterface::beginWriteBatch()
+{
+    m_ldi->beginTransaction();
+}
+
+void DBInterface::commitWriteBatch()
+{
+    m_ldi->commitTransaction();
+}
+
 const QString &DBInterface::dataFile() const
 {
     return m_ldi->dataFile();
@@ -196,6 +215,7 @@ void DBInterface::setDataFile(const QString &file, bool ignoreUser)
         m_rsi->setSsl(config.useSsl);
         m_rsi->setServerPort(config.port);
         m_updateFrequency = config.updateDelay;
+        m_syncInterval = m_updateFrequency;
 
         // Get the serverUuid we should be connecting to
         QString serverUuid = m_ldi->serverUuid();
@@ -296,6 +316,21 @@ void DBInterface::setCurrentUserUuid(QString uuid)
     m_ldi->setCurrentUserUuid(uuid);
 }
 
+const SyncStats &DBInterface::lastSyncStats() const
+{
+    return m_rsi->lastSyncStats();
+}
+
+const QDateTime &DBInterface::nextSync() const
+{
+    return m_nextSync;
+}
+
+const QString &DBInterface::nextSyncReason() const
+{
+    return m_nextSyncReason;
+}
+
 void DBInterface::suspendSync()
 {
     m_updateTimer->stop();
@@ -305,7 +340,8 @@ void DBInterface::suspendSync()
 void DBInterface::resumeSync()
 {
     m_syncSuspended = false;
-    m_updateTimer->start(m_updateFrequency);
+    m_syncInterval = m_updateFrequency;
+    scheduleSync(m_syncInterval, tr("Sync resumed."));
 }
 
 void DBInterface::suspendAutoSync()
@@ -317,7 +353,8 @@ void DBInterface::suspendAutoSync()
 void DBInterface::resumeAutoSync()
 {
     m_autoSyncSuspended = false;
-    m_updateTimer->start(m_updateFrequency);
+    m_syncInterval = m_updateFrequency;
+    scheduleSync(m_syncInterval, tr("Auto sync resumed."));
 }
 
 QString DBInterface::cleanDabaBase(int deleteDataOlderThan)
@@ -364,8 +401,12 @@ void DBInterface::sync()
         return;
     }
     if (m_connectionStatus != NetworkUtils::Online) return;
+    // One sync at a time: a new one would take over the journal of the current one
+    if (m_rsi->isSyncing() || m_ldi->isSavingSync()) return;
 
     emit syncStarted();
+    m_updateTimer->stop();
+    m_hasLocalChanges = false;
 
     ProgressManager *pm = ProgressManager::instance();
     pm->addToMaximum(3);
@@ -379,6 +420,31 @@ void DBInterface::sync()
     m_rsi->sync(syncData);
 }
 
+void DBInterface::syncTables(QStringList tables)
+{
+    if (m_syncSuspended) return;
+    if (m_connectionStatus != NetworkUtils::Online) return;
+    // After the current sync
+    if (m_rsi->isSyncing() || m_ldi->isSavingSync())
+    {
+        for (const QString &table: qAsConst(tables)) m_remoteChangedTables.insert(table);
+        return;
+    }
+
+    emit syncStarted();
+    m_updateTimer->stop();
+    m_hasLocalChanges = false;
+
+    ProgressManager *pm = ProgressManager::instance();
+    pm->addToMaximum(3);
+    pm->setText(tr("Syncing new data from the server..."));
+
+    SyncData syncData = m_ldi->getSync( false );
+
+    log(tr("Fetching the changes from: %1").arg(tables.join(", ")), DuQFLog::Debug);
+    m_rsi->sync(syncData, tables);
+}
+
 void DBInterface::fullSync()
 {
     if (m_syncSuspended) {
@@ -386,8 +452,12 @@ void DBInterface::fullSync()
         return;
     }
     if (m_connectionStatus != NetworkUtils::Online) return;
+    // One sync at a time: a new one would take over the journal of the current one
+    if (m_rsi->isSyncing() || m_ldi->isSavingSync()) return;
 
     emit syncStarted();
+    m_updateTimer->stop();
+    m_hasLocalChanges = false;
 
     ProgressManager *pm = ProgressManager::instance();
     pm->addToMaximum(3);
@@ -415,12 +485,16 @@ DBInterface::DBInterface(QObject *parent) : DuQFLoggerObject("Database Interface
 
 void DBInterface::connectEvents()
 {
-    connect(m_rsi, &RamServerInterface::syncFinished, this, &DBInterface::finishSync);
+    connect(m_rsi, &RamServerInterface::syncFinished, this, &DBInterface::serverSyncFinished);
+    connect(m_ldi, &LocalDataInterface::syncFinished, this, &DBInterface::finishSync);
     connect(m_rsi, &RamServerInterface::connectionStatusChanged, this, &DBInterface::serverConnectionStatusChanged);
     connect(m_rsi, &RamServerInterface::syncReady, m_ldi, &LocalDataInterface::sync);
+    connect(m_rsi, &RamServerInterface::pageReceived, m_ldi, &LocalDataInterface::stagePulledPage);
     connect(m_rsi, &RamServerInterface::userChanged, this, &DBInterface::serverUserChanged);
     connect(m_rsi, &RamServerInterface::pong, m_ldi, &LocalDataInterface::setServerUuid);
     connect(m_updateTimer, SIGNAL(timeout()), this, SLOT(sync()));
+    connect(m_ldi, &LocalDataInterface::changeJournaled, this, &DBInterface::localDataChanged);
+    connect(m_rsi, &RamServerInterface::remoteChanged, this, &DBInterface::remoteDataChanged);
 }
 
 NetworkUtils::NetworkStatus DBInterface::connectionStatus() const
@@ -474,8 +548,18 @@ void DBInterface::serverUserChanged(QString userUuid, QString username, QString
     }
 }
 
-void DBInterface::finishSync()
+void DBInterface::serverSyncFinished()
+{
+    // Wait for the pulled data to be saved
+    if (m_ldi->isSavingSync()) return;
+    finishSync();
+}
+
+void DBInterface::finishSync(bool withError)
 {
+    // The next sync is scheduled as after a failed sync
+    if (withError) m_rsi->setLastSyncFailed();
+
     if (m_disconnecting)
     {
         // Disconnects from the Ramses Server
@@ -483,8 +567,98 @@ void DBInterface::finishSync()
     }
 
     emit syncFinished();
-    if (!m_autoSyncSuspended) m_updateTimer->start( m_updateFrequency );
-    log(tr("Finished sync."));
+    if (!m_autoSyncSuspended) scheduleNextSync();
+    if (withError) log(tr("Finished sync, but the data from the server couldn't be saved."), DuQFLog::Warning);
+    else log(tr("Finished sync."));
+
+    // Changes notified during the sync
+    if (!m_remoteChangedTables.isEmpty())
+    {
+        QStringList tables = m_remoteChangedTables.values();
+        m_remoteChangedTables.clear();
+        QTimer::singleShot(0, this, [this, tables] () { syncTables(tables); });
+    }
+}
+
+void DBInterface::remoteDataChanged(QStringList tables)
+{
+    if (m_syncSuspended || m_autoSyncSuspended) return;
+
+    // After the current sync
+    if (m_rsi->isSyncing() || m_ldi->isSavingSync())
+    {
+        for (const QString &table: qAsConst(tables)) m_remoteChangedTables.insert(table);
+        return;
+    }
+
+    syncTables(tables);
+}
+
+void DBInterface::localDataChanged()
+{
+    m_hasLocalChanges = true;
+
+    // Not now, the changes will be taken into account after the current sync
+    if (m_syncSuspended || m_autoSyncSuspended) return;
+    if (m_rsi->isSyncing() || m_ldi->isSavingSync()) return;
+
+    // Already scheduled soon enough
+    if (m_updateTimer->isActive() && m_updateTimer->remainingTime() <= m_changeSyncDelay) return;
+
+    scheduleSync(m_changeSyncDelay, tr("Local changes."));
+}
+
+void DBInterface::scheduleNextSync()
+{
+    const SyncStats &stats = m_rsi->lastSyncStats();
+    int maxInterval = m_updateFrequency * 8;
+    QString reason;
+
+    if (stats.withError)
+    {
+        m_syncInterval = qMin(m_syncInterval * 2, maxInterval);
+        reason = tr("The last sync failed, backing off.");
+    }
+    else if (stats.pushedRows + stats.pulledRows + stats.deletedRows == 0)
+    {
+        m_syncInterval = qMin(m_syncInterval * 2, maxInterval);
+        reason = tr("Nothing changed, backing off.");
+    }
+    else
+    {
+        m_syncInterval = m_updateFrequency;
+        reason = tr("Data changed.");
+    }
+
+    // The server is busy
+    if (stats.retryAfter > m_syncInterval)
+    {
+        m_syncInterval = stats.retryAfter;
+        reason = tr("The server asked to wait.");
+    }
+
+    // Changes made during the sync
+    if (m_hasLocalChanges && stats.retryAfter < m_changeSyncDelay)
+    {
+        scheduleSync(m_changeSyncDelay, tr("Local changes."));
+        return;
+    }
+
+    scheduleSync(m_syncInterval, reason);
+}
+
+void DBInterface::scheduleSync(int delay, const QString &reason)
+{
+    // Spread the clients
+    int jitter = delay / 10;
+    if (jitter > 0) delay += QRandomGenerator::global()->bounded(-jitter, jitter + 1);
+
+    m_updateTimer->start(delay);
+    m_nextSync = QDateTime::currentDateTime().addMSecs(delay);
+    m_nextSyncReason = reason;
+
+    log(tr("Next sync in %1 s: %2").arg(delay / 1000).arg(reason), DuQFLog::Debug);
+    emit syncScheduled(m_nextSync, reason);
 }
 
 void DBInterface::serverConnectionStatusChanged(NetworkUtils::NetworkStatus status)
@@ -493,6 +667,7 @@ void DBInterface::serverConnectionStatusChanged(NetworkUtils::NetworkStatus stat
     {
     case NetworkUtils::Offline:
         setConnectionStatus(status, "Disconnected from the Ramses Server.");
+        m_rsi->stopWatching();
         suspendSync();
         suspendAutoSync();
         break;
@@ -500,6 +675,7 @@ void DBInterface::serverConnectionStatusChanged(NetworkUtils::NetworkStatus stat
         setConnectionStatus(status, "Connected to the Ramses Server.");
         resumeSync();
         resumeAutoSync();
+        m_rsi->startWatching();
         break;
     default:
         return;
@@ -43,6 +43,11 @@ public:
     bool isSyncSuspended();
     bool isAutoSyncSuspended();
 
+    // Auto sync scheduling
+    const SyncStats &lastSyncStats() const;
+    const QDateTime &nextSync() const;
+    const QString &nextSyncReason() const;
+
     /**
      * @brief setRamsesPath sets the path to the local data for this database
      * @param p
@@ -53,7 +58,7 @@ public:
     // DATA INTERFACE //
 
     QSet<QString> tableUuids(QString table);
-    bool contains(QString uuid, QString table, bool includeRemoved = false);
+    bool contains(const QString &uuid, const QString &table, bool includeRemoved = false);
 
     void createObject(QString uuid, QString table, QString data);
 
@@ -64,6 +69,12 @@ public:
      * @return The validated/fixed data or an empty string if it's invalid.
      */
     QString validateObjectData(QString data, QString uuid = "", QString type = "", bool ignoreErrors = false);
+    /**
+     * @brief validateJsonData The validation of validateObjectData, without logging; can be used from any thread
+     * @param errorString Set to the parse error if the data is invalid
+     * @return The validated/fixed data or an empty string if it's invalid.
+     */
+    static QString validateJsonData(const QString &data, QString *errorString = nullptr);
 
     void removeObject(QString uuid, QString table);
     void restoreObject(QString uuid, QString table);
@@ -74,6 +85,14 @@ public:
     void setUsername(QString uuid, QString username);
     bool isUserNameAavailable(const QString &userName);
 
+    /**
+     * @brief beginWriteBatch Groups all the following writes in a single transaction,
+     * and coalesces their change signals until commitWriteBatch() is called.
+     * Use a DBWriteBatch to make sure the batch is committed.
+     */
+    void beginWriteBatch();
+    void commitWriteBatch();
+
     const QString &dataFile() const;
     void setDataFile(const QString &file, bool ignoreUser = false);
 
@@ -87,6 +106,8 @@ signals:
     void userChanged(QString);
     void syncFinished();
     void syncStarted();
+    // The auto sync has been scheduled
+    void syncScheduled(QDateTime next, QString reason);
 
 public slots:
     void suspendSync();
@@ -95,6 +116,10 @@ public slots:
     void resumeAutoSync();
     void sync();
     void fullSync();
+    /**
+     * @brief syncTables Pushes the local changes, and fetches only the given tables
+     */
+    void syncTables(QStringList tables);
     /**
      * @brief Changes to offline mode: data is stored locally until we get a connection to the server to sync.
      */
@@ -131,10 +156,24 @@ private slots:
      * @param userUuid
      */
     void serverUserChanged(QString userUuid, QString username, QString data, QString modified);
+    /**
+     * @brief serverSyncFinished is called when the server has finished the sync.
+     * Finishes the sync, unless the LDI is still saving the data we've pulled.
+     */
+    void serverSyncFinished();
     /**
      * @brief finishSync is called when the LDI has finished saving sync. Emits syncFinished and Schedules the next autosync.
+     * @param withError true if the pulled data couldn't be saved
+     */
+    void finishSync(bool withError = false);
+    /**
+     * @brief localDataChanged Syncs sooner when there are local changes
+     */
+    void localDataChanged();
+    /**
+     * @brief remoteDataChanged Syncs the tables notified by the server
      */
-    void finishSync();
+    void remoteDataChanged(QStringList tables);
 
 private:
     /**
@@ -146,6 +185,17 @@ private:
      * @brief Connects all member events (just at the end of constructor method)
      */
     void connectEvents();
+    /**
+     * @brief scheduleNextSync Chooses when to sync next, after a sync:
+     * the interval goes back to m_updateFrequency when there was something to sync,
+     * it's doubled (up to 8 times m_updateFrequency) when there was nothing or the sync failed,
+     * and it's at least what the server asked with a Retry-After header.
+     */
+    void scheduleNextSync();
+    /**
+     * @brief scheduleSync Starts the auto sync timer, with a ±10% jitter to spread the clients
+     */
+    void scheduleSync(int delay, const QString &reason);
     /**
      * @brief The current status (offline, connecting or online)
      */
@@ -167,6 +217,15 @@ private:
      */
     int m_updateFrequency = 60000;
     QTimer *m_updateTimer;
+    // The current auto sync interval, adapted after each sync
+    int m_syncInterval = 60000;
+    // How long to wait after a local change before syncing
+    int m_changeSyncDelay = 5000;
+    bool m_hasLocalChanges = false;
+    // Notified by the server during a sync, to sync after it
+    QSet<QString> m_remoteChangedTables;
+    QDateTime m_nextSync;
+    QString m_nextSyncReason;
     bool m_syncSuspended = true;
     bool m_autoSyncSuspended = true;
     bool m_disconnecting = false;
@@ -0,0 +1,13 @@
+#include "dbwritebatch.h"
+
+#include "dbinterface.h"
+
+DBWriteBatch::DBWriteBatch()
+{
+    DBInterface::instance()->beginWriteBatch();
+}
+
+DBWriteBatch::~DBWriteBatch()
+{
+    DBInterface::instance()->commitWriteBatch();
+}
@@ -0,0 +1,20 @@
+#ifndef DBWRITEBATCH_H
+#define DBWRITEBATCH_H
+
+#include <QtGlobal>
+
+/**
+ * @brief The DBWriteBatch class groups all the database writes made during its lifetime
+ * in a single transaction, committed when it's destroyed.
+ * Use it for bulk edits, like changing a whole selection of status.
+ */
+class DBWriteBatch
+{
+public:
+    DBWriteBatch();
+    ~DBWriteBatch();
+private:
+    Q_DISABLE_COPY(DBWriteBatch)
+};
+
+#endif // DBWRITEBATCH_H
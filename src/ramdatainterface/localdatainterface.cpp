@@ -1,13 +1,18 @@
 #include "localdatainterface.h"
 
+#include <QStorageInfo>
+
 #include "datacrypto.h"
+#include "localdataworker.h"
 #include "datastruct.h"
 #include "duqf-app/app-version.h"
+#include "duqf-app/dusettingsmanager.h"
 #include "duqf-utils/utils.h"
 #include "progressmanager.h"
 #include "statemanager.h"
 #include "ramuser.h"
 #include "ramses.h"
+#include "ramobjectregistry.h"
 
 // INTERFACE
 
@@ -160,72 +165,82 @@ QString LocalDataInterface::getRamsesPath(QString dbFile)
 
 QSet<QString> LocalDataInterface::tableUuids(QString table, bool includeRemoved)
 {
-    // If we've got the info in the cache, use it.
-    if (includeRemoved && CACHE_LOCAL_DATA && m_uuids.contains(table) ) return m_uuids.value(table);
-    if (!includeRemoved && CACHE_LOCAL_DATA && m_uuidsWithoutRemoved.contains(table) ) return m_uuidsWithoutRemoved.value(table);
-
-    // Make sure the table exists
-    createTable(table);
-
-    QString q = "SELECT uuid FROM '%1'";
-    if (!includeRemoved) q += " WHERE removed = 0";
-    q += " ;";
-    QSqlQuery qry = query( q.arg(table) );
+    const QHash<QString, bool> &index = uuidIndex(table);
 
     QSet<QString> data;
-
-    while (qry.next()) data << qry.value(0).toString();
-
-    // Cache
-    if (includeRemoved) m_uuids.insert(table, data);
-    else m_uuidsWithoutRemoved.insert(table, data);
-
+    data.reserve(index.count());
+    for (auto it = index.constBegin(); it != index.constEnd(); ++it)
+    {
+        if (includeRemoved || !it.value()) data << it.key();
+    }
     return data;
 }
 
 QVector<QStringList> LocalDataInterface::tableData(QString table, QHash<QString, QStringList> filters, bool includeRemoved)
 {
-    // Make sure the table exists
-    createTable(table);
+    QSqlDatabase db = QSqlDatabase::database("localdata");
+    return readTableData(db, table, filters, includeRemoved, m_jsonColumns.value(table));
+}
+
+QVector<QStringList> LocalDataInterface::readTableData(QSqlDatabase db, const QString &table, const QHash<QString, QStringList> &filters, bool includeRemoved, const QSet<QString> &jsonColumns)
+{
+    QString q = "SELECT `uuid`, `data`, `modified` FROM \"%1\"";
+    QStringList conditions;
+    QStringList values;
 
-    QString q = "SELECT `uuid`, `data`, `modified` FROM '%1'";
-    if (!includeRemoved) q += " WHERE removed = 0";
+    if (!includeRemoved) conditions << "removed = 0";
 
     // Add filters
-    if (!filters.isEmpty())
+    // The data must satisfy ALL the filters
+    QHash<QString, QStringList>::const_iterator i = filters.constBegin();
+    while (i != filters.constEnd())
     {
-        // Iterate through the filters;
-        // An STL const iterator is the fastest
-        QHash<QString, QStringList>::const_iterator i = filters.constBegin();
-        while (i != filters.constEnd())
-        {
-            QString key = i.key();
-            QStringList values = i.value();
+        QString key = i.key();
+        const QStringList &keyValues = i.value();
 
-            // The data must satisfy ALL the filters
-            if (key != "" && !values.isEmpty())
+        if (key != "" && !keyValues.isEmpty())
+        {
+            // Use the indexed generated column if we have one
+            if (jsonColumns.contains(key))
             {
-                bool first = true;
-                foreach(QString value, values)
+                QStringList placeholders;
+                foreach(QString value, keyValues)
                 {
-                    if (first) {
-                        if (!includeRemoved) q += " AND ";
-                        q += " ( ";
-                    }
-                    else q += " OR ";
-                    first = false;
-                    q += "REPLACE(`data`, ' ', '') LIKE '%\"" + key + "\":\"" + value + "\"%'";
+                    placeholders << "?";
+                    values << value;
                 }
-                q += " )";
+                conditions << "\"" % jsonColumn(key) % "\" IN ( " % placeholders.join(", ") % " )";
+            }
+            else
+            {
+                QStringList likes;
+                foreach(QString value, keyValues)
+                {
+                    likes << "REPLACE(`data`, ' ', '') LIKE ?";
+                    values << "%\"" % key % "\":\"" % value % "\"%";
+                }
+                conditions << "( " % likes.join(" OR ") % " )";
             }
-
-            i++;
         }
+
+        i++;
     }
 
+    if (!conditions.isEmpty()) q += " WHERE " % conditions.join(" AND ");
     q += " ;";
 
-    QSqlQuery qry = query( q.arg(table) );
+    QSqlQuery qry = QSqlQuery(db);
+    qry.setForwardOnly(true);
+    qry.prepare( q.arg(table) );
+    foreach(QString value, values) qry.addBindValue(value);
+    if (!qry.exec())
+    {
+        QString errorMessage = "Something went wrong when reading the data.\nHere's some information:";
+        errorMessage += "\n> " + tr("Query:") + "\n" + qry.lastQuery();
+        errorMessage += "\n> " + tr("Database Error:") + "\n" + qry.lastError().databaseText();
+        errorMessage += "\n> " + tr("Driver Error:") + "\n" + qry.lastError().driverText();
+        LocalDataInterface::instance()->log(errorMessage, DuQFLog::Critical);
+    }
 
     QVector<QStringList> tData;
 
@@ -248,11 +263,12 @@ QVector<QStringList> LocalDataInterface::tableData(QString table, QHash<QString,
     return tData;
 }
 
-bool LocalDataInterface::contains(QString uuid, QString table, bool includeRemoved)
+bool LocalDataInterface::contains(const QString &uuid, const QString &table, bool includeRemoved)
 {
-    // Get all UUIDS
-    QSet<QString> uuids = tableUuids(table, includeRemoved);
-    return uuids.contains(uuid);
+    const QHash<QString, bool> &index = uuidIndex(table);
+    auto it = index.constFind(uuid);
+    if (it == index.constEnd()) return false;
+    return includeRemoved || !it.value();
 
 
     /*QString q = "SELECT uuid FROM '%1' WHERE uuid = '%2';";
@@ -265,182 +281,189 @@ bool LocalDataInterface::contains(QString uuid, QString table, bool includeRemov
 
 QMap<QString, QString> LocalDataInterface::modificationDates(QString table)
 {
-    // Make sure the table exists
-    createTable(table);
-
-    QString q = "SELECT uuid, modified FROM '%1';";
-    q = q.arg(table);
-    QSqlQuery qry = query( q );
+    QString q = "SELECT uuid, modified FROM \"%1\";";
+    QSqlQuery qry = preparedQuery( q.arg(table) );
+    execPrepared( qry );
     QMap<QString, QString> dates;
     while(qry.next())
     {
         dates[ qry.value(0).toString() ] = qry.value(1).toString();
     }
+    qry.finish();
     return dates;
 }
 
 void LocalDataInterface::createObject(QString uuid, QString table, QString data)
 {
-    // Make sure the table exists
-    createTable(table);
-
-    // Remove table cache
-    m_uuids.remove(table);
-    m_uuidsWithoutRemoved.remove(table);
-
     QString newData = data;
 
     if (ENCRYPT_USER_DATA && table == "RamUser") newData = DataCrypto::instance()->clientEncrypt(data);
-    else newData.replace("'", "''");
 
     QDateTime modified = QDateTime::currentDateTimeUtc();
+    QString modifiedStr = modified.toString("yyyy-MM-dd hh:mm:ss");
 
-    QString q = "INSERT INTO '%1' (uuid, data, modified, removed) "
-                "VALUES ('%2', '%3', '%4', 0) "
+    QString q = "INSERT INTO \"%1\" (uuid, data, modified, removed) "
+                "VALUES (:uuid, :data, :modified, 0) "
                 "ON CONFLICT(uuid) DO UPDATE "
                 "SET data=excluded.data, modified=excluded.modified ;";
 
-    query( q.arg(
-                  table,
-                  uuid,
-                  newData,
-                  modified.toString("yyyy-MM-dd hh:mm:ss")
-                  )
-            );
-
-    emit inserted(uuid, data, modified.toString("yyyy-MM-dd hh:mm:ss"), table);
+    QSqlQuery qry = preparedQuery( q.arg(table) );
+    qry.bindValue(":uuid", uuid);
+    qry.bindValue(":data", newData);
+    qry.bindValue(":modified", modifiedStr);
+    execPrepared( qry );
+    journalChange(uuid, table);
+    // An existing row keeps its removed state
+    indexUuid(table, uuid, false, true);
+
+    cacheData(uuid, data, table);
+    emitInserted(uuid, data, modifiedStr, table);
 }
 
 QString LocalDataInterface::objectData(QString uuid, QString table)
 {
-    // Make sure the table exists
-    createTable(table);
+    // Read cache
+    const QString key = table % "/" % uuid;
+    const QString *cached = m_dataCache.object(key);
+    if (cached) return *cached;
 
-    QString q = "SELECT data FROM %1 WHERE uuid = '%2';";
-    QSqlQuery qry = query( q.arg(table, uuid) );
+    QString q = "SELECT data FROM \"%1\" WHERE uuid = :uuid;";
+    QSqlQuery qry = preparedQuery( q.arg(table) );
+    qry.bindValue(":uuid", uuid);
+    execPrepared( qry );
 
+    QString data = "";
     if (qry.first())
     {
-        QString data = qry.value(0).toString();
+        data = qry.value(0).toString();
         if (ENCRYPT_USER_DATA && table == "RamUser") data = DataCrypto::instance()->clientDecrypt(data);
-        return data;
+        cacheData(uuid, data, table);
     }
-    return "";
+    qry.finish();
+    return data;
 }
 
 void LocalDataInterface::setObjectData(QString uuid, QString table, QString data)
 {
-    // Make sure the table exists
-    createTable(table);
-
     QString newData = DBInterface::instance()->validateObjectData(data, uuid, table);
+    cacheData(uuid, newData, table);
 
     QDateTime modified = QDateTime::currentDateTimeUtc();
 
     if (ENCRYPT_USER_DATA && table == "RamUser") newData = DataCrypto::instance()->clientEncrypt(data);
-    else newData.replace("'", "''");
 
-    QString q = "INSERT INTO %1 (data, modified, uuid) "
-                "VALUES ( '%2', '%3', '%4') "
+    QString q = "INSERT INTO \"%1\" (data, modified, uuid) "
+                "VALUES (:data, :modified, :uuid) "
                 "ON CONFLICT(uuid) DO UPDATE "
                 "SET data=excluded.data, modified=excluded.modified ;";
 
     QString modifiedStr = modified.toString("yyyy-MM-dd hh:mm:ss");
-    query( q.arg(table, newData, modifiedStr, uuid) );
-
-    emit dataChanged(uuid, data, modifiedStr, table);
+    QSqlQuery qry = preparedQuery( q.arg(table) );
+    qry.bindValue(":data", newData);
+    qry.bindValue(":modified", modifiedStr);
+    qry.bindValue(":uuid", uuid);
+    execPrepared( qry );
+    journalChange(uuid, table);
+    indexUuid(table, uuid, false, true);
+
+    emitDataChanged(uuid, data, modifiedStr, table);
 }
 
 void LocalDataInterface::removeObject(QString uuid, QString table)
 {
-    // Make sure the table exists
-    createTable(table);
-
     QDateTime modified = QDateTime::currentDateTimeUtc();
 
-    QString q = "UPDATE %1 SET "
+    QString q = "UPDATE \"%1\" SET "
                 "removed = 1,"
-                "modified = '%2' "
-                "WHERE uuid = '%3';";
-    query( q.arg(table, modified.toString("yyyy-MM-dd hh:mm:ss"), uuid) );
-    emit removed(uuid, table);
+                "modified = :modified "
+                "WHERE uuid = :uuid;";
+    QSqlQuery qry = preparedQuery( q.arg(table) );
+    qry.bindValue(":modified", modified.toString("yyyy-MM-dd hh:mm:ss"));
+    qry.bindValue(":uuid", uuid);
+    execPrepared( qry );
+    journalChange(uuid, table);
+    indexUuid(table, uuid, true);
+
+    emitRemoved(uuid, table);
 }
 
 void LocalDataInterface::restoreObject(QString uuid, QString table)
 {
-    // Make sure the table exists
-    createTable(table);
-
     QDateTime modified = QDateTime::currentDateTimeUtc();
 
     // Restore query
-    QString q = "UPDATE %1 SET "
+    QString q = "UPDATE \"%1\" SET "
                 "removed = 0,"
-                "modified = '%2' "
-                "WHERE uuid = '%3';";
+                "modified = :modified "
+                "WHERE uuid = :uuid;";
     QString modifiedStr = modified.toString("yyyy-MM-dd hh:mm:ss");
-    query( q.arg(table, modifiedStr, uuid) );
+    QSqlQuery qry = preparedQuery( q.arg(table) );
+    qry.bindValue(":modified", modifiedStr);
+    qry.bindValue(":uuid", uuid);
+    execPrepared( qry );
+    journalChange(uuid, table);
+    indexUuid(table, uuid, false);
 
     // Get current data
     QString data = objectData(uuid, table);
 
     // Emit inserted
-    emit inserted(uuid, data, modifiedStr, table);
+    emitInserted(uuid, data, modifiedStr, table);
 }
 
 bool LocalDataInterface::isRemoved(QString uuid, QString table)
 {
-    // Make sure the table exists
-    createTable(table);
-
-    QString q = "SELECT removed FROM %1 WHERE uuid = '%2';";
-    QSqlQuery qry = query( q.arg(table, uuid) );
+    QString q = "SELECT removed FROM \"%1\" WHERE uuid = :uuid;";
+    QSqlQuery qry = preparedQuery( q.arg(table) );
+    qry.bindValue(":uuid", uuid);
+    execPrepared( qry );
 
-    if (qry.first())
-    {
-        return qry.value(0).toBool();
-    }
+    bool removed = true;
+    if (qry.first()) removed = qry.value(0).toBool();
+    qry.finish();
 
-    return true;
+    return removed;
 }
 
 QString LocalDataInterface::modificationDate(QString uuid, QString table)
 {
-    // Make sure the table exists
-    createTable(table);
+    QString q = "SELECT modified FROM \"%1\" WHERE uuid = :uuid;";
+    QSqlQuery qry = preparedQuery( q.arg(table) );
+    qry.bindValue(":uuid", uuid);
+    execPrepared( qry );
 
-    QString q = "SELECT modified FROM %1 WHERE uuid = '%2';";
-    QSqlQuery qry = query( q.arg(table, uuid) );
-
-    if (qry.first())
-    {
-        return qry.value(0).toString();
-    }
+    QString modified = "1818-05-05 00:00:00";
+    if (qry.first()) modified = qry.value(0).toString();
+    qry.finish();
 
-    return "1818-05-05 00:00:00";
+    return modified;
 }
 
 void LocalDataInterface::setUsername(QString uuid, QString username)
 {
-    username.replace("'", "''");
-
     QDateTime modified = QDateTime::currentDateTimeUtc();
 
-    QString q = "INSERT INTO RamUser (userName, modified, uuid) "
-                "VALUES ('%1', '%2', '%3') "
-                "ON CONFLICT(uuid) DO UPDATE "
-                "SET userName=excluded.userName, modified=excluded.modified ;";
-    query( q.arg(username, modified.toString("yyyy-MM-dd hh:mm:ss"), uuid) );
+    QSqlQuery qry = preparedQuery( "INSERT INTO RamUser (userName, modified, uuid) "
+                                   "VALUES (:userName, :modified, :uuid) "
+                                   "ON CONFLICT(uuid) DO UPDATE "
+                                   "SET userName=excluded.userName, modified=excluded.modified ;" );
+    qry.bindValue(":userName", username);
+    qry.bindValue(":modified", modified.toString("yyyy-MM-dd hh:mm:ss"));
+    qry.bindValue(":uuid", uuid);
+    execPrepared( qry );
+    journalChange(uuid, "RamUser");
 }
 
 bool LocalDataInterface::isUserNameAavailable(const QString &userName)
 {
-    QString q = "SELECT `uuid` FROM `RamUser` WHERE userName = '%1' AND removed = 0;";
-    q = q.arg( userName );
-    QSqlQuery qry = query( q );
-
-    if (qry.first() && qry.value(0) != "") return false;
-    return true;
+    QSqlQuery qry = preparedQuery( "SELECT `uuid` FROM `RamUser` WHERE userName = :userName AND removed = 0;" );
+    qry.bindValue(":userName", userName);
+    execPrepared( qry );
+
+    bool available = true;
+    if (qry.first() && qry.value(0) != "") available = false;
+    qry.finish();
+    return available;
 }
 
 void LocalDataInterface::updateUser(QString uuid, QString username, QString data, QString modified)
@@ -455,25 +478,31 @@ void LocalDataInterface::updateUser(QString uuid, QString username, QString data
     // Encrypt data
     QString newData = data;
     if (ENCRYPT_USER_DATA) newData = DataCrypto::instance()->clientEncrypt( newData );
-    else newData.replace("'", "''");
 
     // Insert/update
-    QString q = "INSERT INTO RamUser (data, modified, uuid, userName, removed) "
-                "VALUES ( '%1', '%2', '%3', '%4', 0) "
-                "ON CONFLICT(uuid) DO UPDATE "
-                "SET data=excluded.data, modified=excluded.modified, userName=excluded.userName, removed=0 ;";
-
-    query( q.arg(newData, modified, uuid, username) );
+    QSqlQuery qry = preparedQuery( "INSERT INTO RamUser (data, modified, uuid, userName, removed) "
+                                   "VALUES (:data, :modified, :uuid, :userName, 0) "
+                                   "ON CONFLICT(uuid) DO UPDATE "
+                                   "SET data=excluded.data, modified=excluded.modified, userName=excluded.userName, removed=0 ;" );
+    qry.bindValue(":data", newData);
+    qry.bindValue(":modified", modified);
+    qry.bindValue(":uuid", uuid);
+    qry.bindValue(":userName", username);
+    execPrepared( qry );
 
     // Remove duplicates if any. This should never happen,
     // but when messing around with new databases and server install
     // Users may end up connecting to a new server while already having some users locally
     QDateTime m = QDateTime::currentDateTimeUtc();
     modified = m.toString("yyyy-MM-dd hh:mm:ss");
-    q = "UPDATE RamUser SET `removed` = 1, `modified` = '%1' WHERE `userName` = '%2' AND `uuid` != '%3';";
-    query( q.arg(modified, username, uuid) );
-
-    emit dataChanged(uuid, data, modified, "RamUser");
+    QSqlQuery dupQry = preparedQuery( "UPDATE RamUser SET `removed` = 1, `modified` = :modified WHERE `userName` = :userName AND `uuid` != :uuid;" );
+    dupQry.bindValue(":modified", modified);
+    dupQry.bindValue(":userName", username);
+    dupQry.bindValue(":uuid", uuid);
+    execPrepared( dupQry );
+
+    cacheData(uuid, data, "RamUser");
+    emitDataChanged(uuid, data, modified, "RamUser");
 }
 
 ServerConfig LocalDataInterface::serverConfig()
@@ -545,8 +574,11 @@ ServerConfig LocalDataInterface::setDataFile(const QString &file)
     qDebug() << ">> Opening local file...";
 
     // Clear all cache
-    m_uuids.clear();
-    m_uuidsWithoutRemoved.clear();
+    m_uuidIndex.clear();
+    m_dataCache.clear();
+    // Prepared queries and the storage thread connection belong to the previous file
+    clearPreparedQueries();
+    closeWorkerFile();
 
     qDebug() << ">> Cleared cache: " << timer.elapsed()/1000 << " seconds.";
 
@@ -558,11 +590,24 @@ ServerConfig LocalDataInterface::setDataFile(const QString &file)
 
     qDebug() << ">> Opened file: " << timer.elapsed()/1000 << " seconds.";
 
+    // Tune SQLite for this file
+    if (file != "") m_storageProfile = applyStorageProfile(db, file, DuSettingsManager::instance()->dbStorageProfile());
+
+    qDebug() << ">> Storage profile set: " << timer.elapsed()/1000 << " seconds.";
+
     pm->increment();
     pm->setText(tr("Loading data..."));
 
     m_dataFile = file;
 
+    // Check which filters can use the generated columns
+    loadJsonColumns();
+
+    // Start the storage thread on this file
+    openWorkerFile();
+
+    m_maintenanceTimer->start();
+
     emit dataResetCommon();
     emit dataResetProject();
 
@@ -611,10 +656,12 @@ SyncData LocalDataInterface::getSync(bool fullSync)
     pm->increment();
 
     // List all tables
-    QStringList tNames = tableNames();
-
     // Ignore History for now to improve performance (as it is not used in Ramses yet)
-    tNames.removeAll("RamStatusHistory");
+    QVector<TableDescriptor> tDescriptors;
+    for (const TableDescriptor &t: tableDescriptors())
+    {
+        if (t.name != "RamStatusHistory") tDescriptors << t;
+    }
 
     // Get last Sync
     QString lastSync = "1818-05-05 00:00:00";
@@ -625,34 +672,49 @@ SyncData LocalDataInterface::getSync(bool fullSync)
         if (qry.first()) lastSync = qry.value(0).toString();
     }
 
+    // The journal entries pushed with this sync, removed once it's done
+    qint64 changeId = 0;
+    QSet<QString> changedTables;
+    QSqlQuery journalQry = query( "SELECT MAX(id) FROM _Changes;" );
+    if (journalQry.first()) changeId = journalQry.value(0).toLongLong();
+    if (!fullSync)
+    {
+        journalQry = query( QString("SELECT DISTINCT tableName FROM _Changes WHERE id <= %1;").arg(changeId) );
+        while (journalQry.next()) changedTables << journalQry.value(0).toString();
+    }
+
     // For each table, get modified rows
 
     RamUser *u = Ramses::instance()->currentUser();
     QString currentUuid = "";
     if (u) currentUuid = u->uuid();
 
-    pm->addToMaximum(tNames.count() + 2);
+    pm->addToMaximum(tDescriptors.count() + 2);
 
     QHash<QString, QSet<TableRow>> tables;
 
-    for (int i = 0; i < tNames.count(); i++)
-    {      
-        QString tName = tNames.at(i);
+    for (const TableDescriptor &t: qAsConst(tDescriptors))
+    {
+        QString tName = t.name;
 
         pm->setText(tr("Scanning table: %1").arg(tName));
         pm->increment();
 
         QSet<TableRow> rows;
 
-        // Make sure the table exists
-        createTable(tName);
+        // Only the journaled rows, if any
+        if (!fullSync && !changedTables.contains(tName))
+        {
+            tables.insert(tName, rows);
+            continue;
+        }
 
         QString q;
-        if (tName == "RamUser") q = "SELECT uuid, data, modified, removed, userName FROM %1 ";
+        if (t.hasUserName) q = "SELECT uuid, data, modified, removed, userName FROM %1 ";
         else q = "SELECT uuid, data, modified, removed FROM %1 ";
-        if (!fullSync) q += " WHERE modified >= '%2' ;";
+        if (!fullSync) q += " WHERE uuid IN (SELECT uuid FROM _Changes WHERE tableName = '%1' AND id <= %2) ;";
 
-        if (!fullSync) q = q.arg(tName, lastSync);
+        if (!fullSync) q = q.arg(tName).arg(changeId);
         else q = q.arg(tName);
 
         QSqlQuery qry = query( q );
@@ -665,11 +727,8 @@ SyncData LocalDataInterface::getSync(bool fullSync)
             row.removed = qry.value(3).toInt();
 
             QString data = qry.value(1).toString();
-            if (tName == "RamUser")
-            {
-                if (ENCRYPT_USER_DATA) data = DataCrypto::instance()->clientDecrypt( data );
-                row.userName = qry.value(4).toString();
-            }
+            if (tName == "RamUser" && ENCRYPT_USER_DATA) data = DataCrypto::instance()->clientDecrypt( data );
+            if (t.hasUserName) row.userName = qry.value(4).toString();
 
             row.data = data;
             rows.insert(row);
@@ -681,6 +740,7 @@ SyncData LocalDataInterface::getSync(bool fullSync)
     SyncData syncData;
     syncData.syncDate = lastSync;
     syncData.tables = tables;
+    syncData.changeId = changeId;
 
     pm->setText(tr("Successfully scanned local data."));
     pm->increment();
@@ -688,232 +748,9 @@ SyncData LocalDataInterface::getSync(bool fullSync)
     return syncData;
 }
 
-void LocalDataInterface::saveSync(SyncData syncData)
-{
-    StateManager::State previousState = StateManager::i()->state();
-    StateManager::i()->setState(StateManager::WritingDataBase);
-
-    QHash<QString, QSet<TableRow>> tables = syncData.tables;
-
-    ProgressManager *pm = ProgressManager::instance();
-    pm->addToMaximum(tables.count()*2);
-
-    // Insertions
-    QHashIterator<QString, QSet<TableRow>> i(tables);
-
-    while (i.hasNext()) {
-
-        pm->increment();
-
-        i.next();
-        QString tableName = i.key();
-        if (tableName == "") continue;
-
-        // Make sure the table exists
-        createTable(tableName);
-
-        QSet<QStringList> insertedObjects;
-
-        pm->setText(tr("Inserting new data in: %1").arg(tableName));
-
-        // Clear cache
-        m_uuids.remove(tableName);
-        m_uuidsWithoutRemoved.remove(tableName);
-
-        // We're going to need the uuids and dates of the table
-        QMap<QString, QString> uuidDates = modificationDates( tableName );
-
-        // In a single query
-        QString q;
-        if (tableName == "RamUser") q = "INSERT INTO %1 (data, modified, uuid, removed, userName) VALUES ";
-        else q = "INSERT INTO %1 (data, modified, uuid, removed) VALUES ";
-        q = q.arg(tableName);
-
-        QStringList values;
-
-        QSet<TableRow> incomingRows = i.value();
-        foreach(TableRow incomingRow, incomingRows)
-        {
-            // Check if row exists
-            QString uuid = incomingRow.uuid;
-
-            if (uuid == "") continue;
-
-            if (uuidDates.contains(uuid)) continue;
-
-            QString data = DBInterface::instance()->validateObjectData(incomingRow.data, uuid, tableName);
-
-            QString modified = incomingRow.modified;
-            int removed = incomingRow.removed;
-
-            if (tableName == "RamUser")
-            {
-                QString userName = incomingRow.userName.replace("'", "''");
-                if (userName == "Ramses") continue;
-                if (ENCRYPT_USER_DATA) data = DataCrypto::instance()->clientEncrypt( data );
-                else data.replace("'", "''");
-
-                QString v = "( '%1', '%2', '%3', %4, '%5' )";
-                values << v.arg( data, modified, uuid, QString::number(removed), userName );
-            }
-            else
-            {
-                data.replace("'", "''");
-
-                QString v = "( '%1', '%2', '%3', %4 )";
-                values << v.arg( data, modified, uuid, QString::number(removed) );
-            }
-
-            if (removed == 0)
-            {
-                QStringList ins;
-                ins << uuid << incomingRow.data << modified << tableName;
-                insertedObjects << ins;
-            }
-        }
-
-        // Nothing, next table
-        if (values.count() == 0) continue;
-
-        q += values.join(", ");
-
-        query( q );
-
-        // Emit insertions
-        StateManager::i()->setState(StateManager::LoadingDataBase);
-        foreach(QStringList io, insertedObjects ) {
-            emit inserted( io.at(0), io.at(1), io.at(2), io.at(3) );
-        }
-    }
-
-    StateManager::i()->setState(StateManager::WritingDataBase);
-
-    // Updates
-    i.toFront();
-    while (i.hasNext()) {
-        pm->increment();
-
-        i.next();
-        QString tableName = i.key();
-        if (tableName == "") continue;
-
-        // Make sure the table exists
-        createTable(tableName);
-
-        pm->setText(tr("Updating existing data for: %1").arg(tableName));
-
-        // Clear cache
-        m_uuids.remove(tableName);
-        m_uuidsWithoutRemoved.remove(tableName);
-
-        QSet<TableRow> incomingRows = i.value();
-
-        // We're going to need the uuids and dates of the table
-        QMap<QString, QString> uuidDates = modificationDates( tableName );
-
-        // In a single query
-        QString q;
-        if (tableName == "RamUser") q = "INSERT INTO %1 (data, modified, uuid, removed, userName) VALUES ";
-        else q = "INSERT INTO %1 (data, modified, uuid, removed) VALUES ";
-        q = q.arg(tableName);
-
-        QStringList values;
-        QSet<QStringList> changedUuids;
-
-        foreach(TableRow incomingRow, incomingRows)
-        {
-            QString uuid = incomingRow.uuid;
-            if (uuid == "") continue;
-            QString data = DBInterface::instance()->validateObjectData(incomingRow.data, uuid, tableName);
-
-            QString modified = incomingRow.modified;
-            int rem = incomingRow.removed;
-            bool hasBeenRemoved = rem == 1;
-
-            // Only if more recent
-            QDateTime incomingDate = QDateTime::fromString(modified, "yyyy-MM-dd hh:mm:ss");
-            QDateTime currentDate = QDateTime::fromString(uuidDates[uuid], "yyyy-MM-dd hh:mm:ss");
-            if (incomingDate <= currentDate) continue;
-
-            // Check if the object has been removed or restored
-            bool wasRemoved = isRemoved(uuid, tableName);
-            bool availChanged = wasRemoved != hasBeenRemoved;
-            if (availChanged) {
-                emit availabilityChanged(uuid, !hasBeenRemoved);
-                if (hasBeenRemoved) emit removed(uuid, tableName);
-            }
-
-            if (tableName == "RamUser")
-            {
-                QString userName = incomingRow.userName.replace("'", "''");
-
-                if (ENCRYPT_USER_DATA) data = DataCrypto::instance()->clientEncrypt( data );
-                else data.replace("'", "''");
-
-                QString v = "( '%1', '%2', '%3', %4, '%5' )";
-                values << v.arg( data, modified, uuid, QString::number(rem), userName );
-            }
-            else
-            {
-                data.replace("'", "''");
-                QString v = "( '%1', '%2', '%3', %4 )";
-                values << v.arg( data, modified, uuid, QString::number(rem) );
-            }
-
-            QStringList cu;
-            cu << uuid << data << modified;
-            changedUuids << cu;
-        }
-
-        // Nothing, next table
-        if (values.count() == 0) continue;
-
-        q += values.join(", ") + " ON CONFLICT(uuid) DO UPDATE SET ";
-
-        if (tableName == "RamUser") q +="`data` = excluded.data, `modified` = excluded.modified, `removed` = excluded.removed, `userName` = excluded.userName ;";
-        else q += "`data` = excluded.data, `modified` = excluded.modified, `removed` = excluded.removed ;";
-
-        query( q );
-
-        // Emit
-        StateManager::i()->setState(StateManager::LoadingDataBase);
-        foreach(QStringList cu, changedUuids) {
-            emit dataChanged(cu.at(0), cu.at(1), cu.at(2), tableName);
-        }
-    }
-
-    emit syncFinished();
-
-    StateManager::i()->setState(previousState);
-}
-
-void LocalDataInterface::deleteData(SyncData syncData)
+bool LocalDataInterface::isSavingSync() const
 {
-    ProgressManager *pm = ProgressManager::instance();
-
-    QHash<QString, QStringList> tables = syncData.deletedUuids;
-    QHashIterator<QString, QStringList> i(tables);
-
-    pm->addToMaximum(tables.count());
-
-    while (i.hasNext()) {
-
-        i.next();
-
-        pm->increment();
-
-        QString tableName = i.key();
-        QStringList rows = i.value();
-
-        pm->setText(tr("Removing out-of-date data from: %1").arg(tableName));
-
-        for (int j = 0; j < rows.count(); j++)
-        {
-            QString uuid = rows.at(j);
-            QString q = "DELETE FROM %1 WHERE `uuid` = '%2';";
-            query( q.arg( tableName, uuid ) );
-        }
-    }
+    return m_savingSync;
 }
 
 QString LocalDataInterface::currentUserUuid()
@@ -942,24 +779,99 @@ void LocalDataInterface::sync(SyncData data, QString serverUuid)
 {
     ProgressManager *pm = ProgressManager::instance();
     pm->setText(tr("Updating local data..."));
-    pm->addToMaximum(1);
+    pm->addToMaximum(data.tables.count() + data.deletedUuids.count() + 1);
 
-    saveSync(data);
-    deleteData(data);
+    // The server has committed our changes, they're not needed anymore
+    // (the ones made since then are kept for the next sync)
+    // Only the ones pushed by this sync: other syncs may have been started since
+    if (data.changeId > 0) query( QString("DELETE FROM _Changes WHERE id <= %1;").arg(data.changeId) );
 
-    // Save sync date
+    m_stateBeforeSync = StateManager::i()->state();
+    StateManager::i()->setState(StateManager::WritingDataBase);
+    m_savingSync = true;
 
-    pm->increment();
-    pm->setText(tr("Cleaning..."));
+    // Save in the storage thread
+    LocalDataWorker *worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker, data, serverUuid]() {
+        worker->saveSync(data, serverUuid);
+    }, Qt::QueuedConnection);
+}
 
-    QString q = "DELETE FROM _Sync;";
-    query( q );
-    q = "INSERT INTO _Sync ( lastSync, uuid ) VALUES ( '%1', '%2' );";
-    query( q.arg( data.syncDate, serverUuid ) );
+void LocalDataInterface::stagePulledPage(TableFetchData table, int page, QSet<TableRow> rows, QStringList deletedUuids)
+{
+    LocalDataWorker *worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker, table, page, rows, deletedUuids]() {
+        worker->stagePage(table, page, rows, deletedUuids);
+    }, Qt::QueuedConnection);
+}
+
+QHash<QString, QSet<int> > LocalDataInterface::resumePull(const QSet<TableFetchData> &tables)
+{
+    QHash<QString, QSet<int>> pages;
+
+    QSqlQuery qry = query( "SELECT tableName, page, pageCount, rowCount, previousSyncDate, fingerprint FROM _PullPages;" );
+    while (qry.next())
+    {
+        TableFetchData key;
+        key.name = qry.value(0).toString();
+        QSet<TableFetchData>::const_iterator it = tables.constFind(key);
+        if (it == tables.constEnd()) continue;
+        // The pages were fetched from another date, or the data has changed on the server since:
+        // the pages don't match anymore.
+        // Without a fingerprint from the server, there's no way to know, they can't be reused.
+        if (it->pageCount != qry.value(2).toInt() || it->rowCount != qry.value(3).toInt()) continue;
+        if (it->previousSyncDate != qry.value(4).toString()) continue;
+        if (it->fingerprint == "" || it->fingerprint != qry.value(5).toString()) continue;
+        pages[key.name].insert(qry.value(1).toInt());
+    }
+
+    // Remove what can't be resumed
+    QStringList keepTables = pages.keys();
+    LocalDataWorker *worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker, keepTables]() {
+        worker->clearStaging(keepTables);
+    }, Qt::QueuedConnection);
+
+    return pages;
+}
+
+const QVector<TableDescriptor> &LocalDataInterface::tableDescriptors()
+{
+    static const QVector<TableDescriptor> descriptors = loadTableDescriptors();
+    return descriptors;
+}
+
+TableDescriptor LocalDataInterface::tableDescriptor(const QString &name)
+{
+    for (const TableDescriptor &t: tableDescriptors())
+    {
+        if (t.name == name) return t;
+    }
+    TableDescriptor t;
+    t.name = name;
+    return t;
+}
+
+bool LocalDataInterface::isDataTable(const QString &name)
+{
+    for (const TableDescriptor &t: tableDescriptors())
+    {
+        if (t.name == name) return true;
+    }
+    return false;
 }
 
 QStringList LocalDataInterface::tableNames()
 {
+    QStringList tables;
+    for (const TableDescriptor &t: tableDescriptors()) tables << t.name;
+    return tables;
+}
+
+QVector<TableDescriptor> LocalDataInterface::loadTableDescriptors()
+{
+    QVector<TableDescriptor> descriptors;
+
     QSqlDatabase db = QSqlDatabase::database("infodb");
     db.close();
 
@@ -970,7 +882,7 @@ QStringList LocalDataInterface::tableNames()
     if (!db.open())
     {
         qDebug() << "Can't open template DB";
-        return QStringList();
+        return descriptors;
     }
 
     // Get info
@@ -980,7 +892,7 @@ QStringList LocalDataInterface::tableNames()
     {
         qDebug() << "Can't query template DB";
         qDebug() << qry.lastError().text();
-        return QStringList();
+        return descriptors;
     }
 
     QStringList tables;
@@ -990,12 +902,38 @@ QStringList LocalDataInterface::tableNames()
         if (name.startsWith("Ram")) tables << name;
     }
 
+    // The keys used to filter the tables in the models.
+    // RamUser is not there: its data is encrypted
+    QHash<QString, QStringList> jsonKeys;
+    jsonKeys.insert("RamAsset", QStringList() << "project" << "assetGroup");
+    jsonKeys.insert("RamAssetGroup", QStringList() << "project");
+    jsonKeys.insert("RamSequence", QStringList() << "project");
+    jsonKeys.insert("RamShot", QStringList() << "project" << "sequence");
+    jsonKeys.insert("RamStep", QStringList() << "project" << "type");
+    jsonKeys.insert("RamPipe", QStringList() << "project");
+    jsonKeys.insert("RamPipeFile", QStringList() << "project");
+    jsonKeys.insert("RamStatus", QStringList() << "item" << "step");
+    jsonKeys.insert("RamScheduleEntry", QStringList() << "project" << "user" << "step" << "row" << "date");
+    jsonKeys.insert("RamScheduleRow", QStringList() << "project");
+    jsonKeys.insert("RamScheduleComment", QStringList() << "project" << "date");
+
+    foreach(QString name, tables)
+    {
+        TableDescriptor t;
+        t.name = name;
+        qry.exec(QString("PRAGMA table_info(\"%1\");").arg(name));
+        while (qry.next()) t.columns << qry.value(1).toString();
+        t.hasUserName = t.columns.contains("userName");
+        t.jsonKeys = jsonKeys.value(name);
+        descriptors << t;
+    }
+
     db.close();
 
     // Remove the temp file
     QFile::remove(tempDB);
 
-    return tables;
+    return descriptors;
 }
 
 QVector<QStringList> LocalDataInterface::users()
@@ -1012,6 +950,44 @@ QVector<QStringList> LocalDataInterface::users()
     return us;
 }
 
+void LocalDataInterface::beginTransaction()
+{
+    m_transactionDepth++;
+    if (m_transactionDepth > 1) return;
+
+    QSqlDatabase db = QSqlDatabase::database("localdata");
+    if (!db.transaction())
+        log(tr("Can't begin a transaction:") + "\n" + db.lastError().text(), DuQFLog::Warning);
+}
+
+void LocalDataInterface::commitTransaction()
+{
+    if (m_transactionDepth == 0) return;
+    m_transactionDepth--;
+    if (m_transactionDepth > 0) return;
+
+    QSqlDatabase db = QSqlDatabase::database("localdata");
+    if (!db.commit())
+    {
+        log(tr("Can't commit the transaction:") + "\n" + db.lastError().text(), DuQFLog::Critical);
+        db.rollback();
+        discardPendingChanges();
+        return;
+    }
+
+    flushPendingChanges();
+}
+
+bool LocalDataInterface::isInTransaction() const
+{
+    return m_transactionDepth > 0;
+}
+
+bool LocalDataInterface::isFlushingTransaction() const
+{
+    return m_flushingTransaction;
+}
+
 QString LocalDataInterface::cleanDataBase(int deleteDataOlderThan)
 {
     StateManager::State previousState = StateManager::i()->state();
@@ -1020,20 +996,25 @@ QString LocalDataInterface::cleanDataBase(int deleteDataOlderThan)
     QString report = "";
 
     // Backup the DB File
+    // Make sure everything is in the main file first
+    checkpoint();
     QFileInfo dbFileInfo(m_dataFile);
     QString backupFile = dbFileInfo.path() + "/" + dbFileInfo.baseName() + "_bak." + dbFileInfo.completeSuffix();
     if (QFileInfo::exists(backupFile)) FileUtils::remove(backupFile);
     FileUtils::copy(m_dataFile, backupFile);
 
     // Clear cache
-    m_uuids.clear();
-    m_uuidsWithoutRemoved.clear();
+    // (the uuid index is updated in place when the rows are deleted)
+    m_dataCache.clear();
 
     // Get needed data
 
     // Users (not removed)
     QSet<QString> userUuids = tableUuids("RamUser", false);
 
+    // All changes at once
+    beginTransaction();
+
     // 1- Clean Statuses
     report += "# Cleaning report\n\n";
     report += ".\n\n## Status\n\n";
@@ -1087,17 +1068,17 @@ QString LocalDataInterface::cleanDataBase(int deleteDataOlderThan)
             qDebug() << "    From: " << table;
 
             // List uuids to remove
-            QString q = "SELECT uuid FROM %1 WHERE `removed` = 1 AND `modified` <= '%2'";
+            QString q = "SELECT uuid FROM \"%1\" WHERE `removed` = 1 AND `modified` <= '%2'";
             QSqlQuery qry = query( q.arg(table, limitDate) );
 
-            // Collect and remove uuids
+            // Collect uuids
             QSet<QString> uuids;
-            while (qry.next()) {
-                QString uuid = qry.value(0).toString();
-                q = "DELETE FROM %1 WHERE `uuid` = '%2' AND `removed` = 1;";
-                query( q.arg(table, uuid) );
-                uuids.insert( uuid );
-            }
+            while (qry.next()) uuids.insert( qry.value(0).toString() );
+            qry.finish();
+
+            // And remove them all at once
+            if (!deleteRows(QSqlDatabase::database("localdata"), table, uuids.values(), "`removed` = 1", true)) continue;
+            for (const QString &uuid: qAsConst(uuids)) unindexUuid(table, uuid);
 
             int count = uuids.count();
             if (count > 0) {
@@ -1110,6 +1091,8 @@ QString LocalDataInterface::cleanDataBase(int deleteDataOlderThan)
         if (!dataRemoved) report += "*Nothing was found to delete.*\n\n";
     }
 
+    commitTransaction();
+
     // Vacuum
     vacuum();
     report += ".\n\n## Maintenance\n\n";
@@ -1130,10 +1113,17 @@ bool LocalDataInterface::undoClean()
     if (!QFileInfo::exists(backupFile)) return false;
 
     // Unset the database file
+    clearPreparedQueries();
+    closeWorkerFile();
+    m_dataCache.clear();
+    m_uuidIndex.clear();
     QSqlDatabase db = QSqlDatabase::database("localdata");
     db.close();
 
     FileUtils::moveToTrash(m_dataFile);
+    // Don't let a remaining WAL be applied to the restored file
+    QFile::remove(m_dataFile + "-wal");
+    QFile::remove(m_dataFile + "-shm");
     FileUtils::copy(backupFile, m_dataFile);
 
     return true;
@@ -1146,8 +1136,18 @@ void LocalDataInterface::logError(QString err)
 
 void LocalDataInterface::quit()
 {
+    m_maintenanceTimer->stop();
+
+    // Let the storage thread finish its work
+    closeWorkerFile();
+    m_workerThread.quit();
+    m_workerThread.wait();
+
+    // A full vacuum rewrites the whole file, it's run by maintain() when idle;
+    // just free what's quick to free.
     qDebug() << "LocalDataInterface: Vacuuming...";
-    vacuum();
+    if (m_dataFile != "") incrementalVacuum( QSqlDatabase::database("localdata") );
+    checkpoint();
     //waitForReady();
     qDebug() << "LocalDataInterface: Everything's clean.";
 }
@@ -1155,6 +1155,8 @@ void LocalDataInterface::quit()
 LocalDataInterface::LocalDataInterface():
     DuQFLoggerObject("Local Data Interface")
 {
+    m_dataCache.setMaxCost(LOCAL_DATA_CACHE_SIZE);
+
     //Load local database
     QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE","localdata");
     db.setHostName("localhost");
@@ -1164,9 +1166,42 @@ LocalDataInterface::LocalDataInterface():
     QSqlDatabase infodb = QSqlDatabase::addDatabase("QSQLITE","infodb");
     infodb.setHostName("localhost");
 
-    //m_queryThread.start();
+    // Describe the tables now: it needs the infodb connection, which belongs to this thread
+    tableDescriptors();
+
+    // Maintenance, after 10 minutes without local changes
+    m_maintenanceTimer = new QTimer(this);
+    m_maintenanceTimer->setSingleShot(true);
+    m_maintenanceTimer->setInterval(10*60*1000);
+    connect(m_maintenanceTimer, &QTimer::timeout, this, &LocalDataInterface::maintain);
+
+    // Storage thread
+    qRegisterMetaType<QVector<TableChange>>("QVector<TableChange>");
+    m_worker = new LocalDataWorker();
+    m_worker->moveToThread(&m_workerThread);
+    connect(&m_workerThread, &QThread::finished, m_worker, &QObject::deleteLater);
+    connect(m_worker, &LocalDataWorker::progress, this, &LocalDataInterface::workerProgress);
+    connect(m_worker, &LocalDataWorker::changesSaved, this, &LocalDataInterface::workerChangesSaved);
+    connect(m_worker, &LocalDataWorker::syncSaved, this, &LocalDataInterface::workerSyncSaved);
+    connect(m_worker, &LocalDataWorker::vacuumed, this, &LocalDataInterface::workerVacuumed);
+    m_workerThread.start();
 
     connect(qApp, &QApplication::aboutToQuit, this, &LocalDataInterface::quit);
+    connect(DuSettingsManager::instance(), &DuSettingsManager::dbStorageProfileChanged, this, &LocalDataInterface::storageProfileChanged);
+}
+
+void LocalDataInterface::storageProfileChanged()
+{
+    if (m_dataFile == "") return;
+
+    // Prepared statements and other connections must be reset before changing the journal mode
+    clearPreparedQueries();
+    closeWorkerFile();
+
+    QSqlDatabase db = QSqlDatabase::database("localdata");
+    m_storageProfile = applyStorageProfile(db, m_dataFile, DuSettingsManager::instance()->dbStorageProfile());
+
+    openWorkerFile();
 }
 
 bool LocalDataInterface::openDB(QSqlDatabase db, const QString &dbFile)
@@ -1190,22 +1225,100 @@ bool LocalDataInterface::openDB(QSqlDatabase db, const QString &dbFile)
 
     QSqlQuery qry = QSqlQuery(db);
 
+    // If the file was left with a WAL, move its content to the main file
+    // before anything else (like copying the file)
+    qry.exec("PRAGMA wal_checkpoint(TRUNCATE);");
+
     // Check DB Version
     qry.exec("CREATE TABLE IF NOT EXISTS _Ramses ("
                   "\"id\"	INTEGER NOT NULL UNIQUE,"
                   "\"version\"	TEXT NOT NULL DEFAULT '0.0.0',"
+                  "\"schema\"	INTEGER NOT NULL DEFAULT 0,"
                   "PRIMARY KEY(\"id\" AUTOINCREMENT)"
                   ");");
-
-    QVersionNumber currentVersion(0,0,0);
-    QVersionNumber newVersion = QVersionNumber::fromString(STR_VERSION);
-
-    qry.exec("SELECT version FROM _Ramses;");
-    if (qry.first())
+    // The schema version (indexes, generated columns) is independent from the app version
+    qry.exec("PRAGMA table_info(_Ramses);");
+    bool hasSchemaVersion = false;
+    while (qry.next()) if (qry.value(1).toString() == "schema") hasSchemaVersion = true;
+    if (!hasSchemaVersion) qry.exec("ALTER TABLE _Ramses ADD COLUMN \"schema\" INTEGER NOT NULL DEFAULT 0;");
+    int schemaVersion = 0;
+    qry.exec("SELECT schema FROM _Ramses;");
+    if (qry.first()) schemaVersion = qry.value(0).toInt();
+
+    // Local changes journal, for the delta sync
+    qry.exec("SELECT name FROM sqlite_master WHERE type = 'table' AND name = '_Changes';");
+    bool hasJournal = qry.first();
+    qry.exec("CREATE TABLE IF NOT EXISTS _Changes ("
+                  "\"id\"	INTEGER NOT NULL UNIQUE,"
+                  "\"tableName\"	TEXT NOT NULL,"
+                  "\"uuid\"	TEXT NOT NULL,"
+                  "PRIMARY KEY(\"id\" AUTOINCREMENT),"
+                  "UNIQUE(\"tableName\", \"uuid\")"
+                  ");");
+    if (!hasJournal)
     {
-        currentVersion = QVersionNumber::fromString( qry.value(0).toString() );
-    }
-
+        // Journal what's been changed since the last sync
+        QString lastSync = "1818-05-05 00:00:00";
+        qry.exec("SELECT lastSync FROM _Sync;");
+        if (qry.first()) lastSync = qry.value(0).toString();
+        for (const TableDescriptor &t: tableDescriptors())
+        {
+            QString q = "INSERT OR IGNORE INTO _Changes (tableName, uuid) SELECT '%1', uuid FROM \"%1\" WHERE modified >= '%2';";
+            qry.exec(q.arg(t.name, lastSync));
+        }
+    }
+
+    // The data pulled from the server, saved page by page until the end of the sync
+    qry.exec("CREATE TABLE IF NOT EXISTS _PullStaging ("
+                  "\"tableName\"	TEXT NOT NULL,"
+                  "\"uuid\"	TEXT NOT NULL,"
+                  "\"data\"	TEXT NOT NULL,"
+                  "\"modified\"	TEXT NOT NULL,"
+                  "\"removed\"	INTEGER NOT NULL DEFAULT 0,"
+                  "\"userName\"	TEXT,"
+                  "\"page\"	INTEGER NOT NULL DEFAULT 0,"
+                  "PRIMARY KEY(\"tableName\", \"uuid\")"
+                  ");");
+    qry.exec("CREATE TABLE IF NOT EXISTS _PullDeleted ("
+                  "\"tableName\"	TEXT NOT NULL,"
+                  "\"uuid\"	TEXT NOT NULL,"
+                  "PRIMARY KEY(\"tableName\", \"uuid\")"
+                  ");");
+    // The staged pages, to resume an interrupted sync
+    // (the pages staged before the fingerprint was recorded can't be reused)
+    qry.exec("PRAGMA table_info(_PullPages);");
+    bool hasPullPages = false;
+    bool hasFingerprint = false;
+    while (qry.next())
+    {
+        hasPullPages = true;
+        if (qry.value(1).toString() == "fingerprint") hasFingerprint = true;
+    }
+    if (hasPullPages && !hasFingerprint)
+    {
+        qry.exec("DROP TABLE _PullPages;");
+        qry.exec("DELETE FROM _PullStaging;");
+        qry.exec("DELETE FROM _PullDeleted;");
+    }
+    qry.exec("CREATE TABLE IF NOT EXISTS _PullPages ("
+                  "\"tableName\"	TEXT NOT NULL,"
+                  "\"page\"	INTEGER NOT NULL,"
+                  "\"pageCount\"	INTEGER NOT NULL,"
+                  "\"rowCount\"	INTEGER NOT NULL,"
+                  "\"previousSyncDate\"	TEXT NOT NULL DEFAULT '',"
+                  "\"fingerprint\"	TEXT NOT NULL DEFAULT '',"
+                  "PRIMARY KEY(\"tableName\", \"page\")"
+                  ");");
+
+    QVersionNumber currentVersion(0,0,0);
+    QVersionNumber newVersion = QVersionNumber::fromString(STR_VERSION);
+
+    qry.exec("SELECT version FROM _Ramses;");
+    if (qry.first())
+    {
+        currentVersion = QVersionNumber::fromString( qry.value(0).toString() );
+    }
+
     bool ok = true;
 
     if (currentVersion < newVersion)
@@ -1278,8 +1391,8 @@ bool LocalDataInterface::openDB(QSqlDatabase db, const QString &dbFile)
         {
             // Remove previous version and update with ours
             qry.exec("DELETE FROM _Ramses;");
-            QString q = "INSERT INTO _Ramses (version) VALUES ('%1');";
-            if (!qry.exec(q.arg(STR_VERSION)))
+            QString q = "INSERT INTO _Ramses (version, schema) VALUES ('%1', %2);";
+            if (!qry.exec(q.arg(STR_VERSION).arg(schemaVersion)))
             {
                 QString errorMessage = "Something went wrong when setting the new version of the database.\nHere's some information:";
                 errorMessage += "\n> " + tr("Query:") + "\n" + qry.lastQuery();
@@ -1298,15 +1411,295 @@ bool LocalDataInterface::openDB(QSqlDatabase db, const QString &dbFile)
         ok = false;
     }
 
+    // Make sure all tables exist, once and for all
+    verifySchema(db);
+
     // If not ok, finished
     if (!ok) return true;
 
+    // Update the indexes of the existing tables
+    if (schemaVersion < SCHEMA_VERSION && updateIndexes(db))
+    {
+        if (!qry.exec(QString("UPDATE _Ramses SET schema = %1;").arg(SCHEMA_VERSION)))
+            LocalDataInterface::instance()->log(tr("Can't set the schema version of the database:") + "\n" + qry.lastError().databaseText(), DuQFLog::Warning);
+    }
+
     // Auto clean!
     autoCleanDB(db);
 
     return true;
 }
 
+StorageProfile LocalDataInterface::applyStorageProfile(QSqlDatabase db, const QString &dbFile, StorageProfile profile)
+{
+    LocalDataInterface *ldi = LocalDataInterface::instance();
+
+    // WAL needs shared memory and mmap needs a reliable lock,
+    // none of them are safe on network file systems
+    if (profile != CompatibleStorage && isOnNetworkFileSystem(dbFile))
+    {
+        ldi->log(tr("The database is on a network drive, using the compatible storage profile.\n"
+                    "Copy the database to a local drive for better performance."), DuQFLog::Information);
+        profile = CompatibleStorage;
+    }
+
+    // Long enough for the other connection to save a sync
+    QStringList pragmas;
+    pragmas << QString("PRAGMA busy_timeout = %1;").arg(DB_BUSY_TIMEOUT);
+    switch(profile)
+    {
+    case CompatibleStorage:
+        pragmas << "PRAGMA journal_mode = DELETE;"
+                << "PRAGMA synchronous = FULL;"
+                << "PRAGMA mmap_size = 0;"
+                // Back to the defaults, if another profile was applied before
+                << "PRAGMA cache_size = -2000;" // 2MB
+                << "PRAGMA temp_store = DEFAULT;";
+        break;
+    case BalancedStorage:
+        pragmas << "PRAGMA journal_mode = WAL;"
+                // With WAL, NORMAL is safe against corruption,
+                // only the last transactions may be lost on power failure
+                << "PRAGMA synchronous = NORMAL;"
+                << "PRAGMA wal_autocheckpoint = 1000;" // pages, ~4MB
+                << "PRAGMA journal_size_limit = 16777216;" // 16MB
+                << "PRAGMA mmap_size = 67108864;" // 64MB
+                << "PRAGMA cache_size = -32000;" // 32MB
+                << "PRAGMA temp_store = MEMORY;";
+        break;
+    case PerformanceStorage:
+        pragmas << "PRAGMA journal_mode = WAL;"
+                << "PRAGMA synchronous = NORMAL;"
+                << "PRAGMA wal_autocheckpoint = 4000;" // pages, ~16MB
+                << "PRAGMA journal_size_limit = 67108864;" // 64MB
+                << "PRAGMA mmap_size = 268435456;" // 256MB
+                << "PRAGMA cache_size = -128000;" // 128MB
+                << "PRAGMA temp_store = MEMORY;";
+        break;
+    }
+
+    QSqlQuery qry = QSqlQuery(db);
+    for (const QString &pragma: qAsConst(pragmas))
+    {
+        if (!qry.exec(pragma))
+        {
+            ldi->log(tr("Can't set the database storage option:") + "\n" + pragma + "\n" + qry.lastError().databaseText(), DuQFLog::Warning);
+            continue;
+        }
+
+        // SQLite may refuse WAL, without error
+        if (pragma.startsWith("PRAGMA journal_mode") && qry.first())
+        {
+            QString mode = qry.value(0).toString().toLower();
+            if (profile != CompatibleStorage && mode != "wal")
+            {
+                ldi->log(tr("WAL journal is not available for this database, using the compatible storage profile."), DuQFLog::Warning);
+                qry.finish();
+                return applyStorageProfile(db, dbFile, CompatibleStorage);
+            }
+        }
+        qry.finish();
+    }
+
+    QString profileName = "compatible";
+    if (profile == BalancedStorage) profileName = "balanced";
+    else if (profile == PerformanceStorage) profileName = "performance";
+    ldi->log(tr("Database storage profile: %1").arg(profileName), DuQFLog::Debug);
+
+    return profile;
+}
+
+bool LocalDataInterface::isOnNetworkFileSystem(const QString &dbFile)
+{
+    QFileInfo dbFileInfo(dbFile);
+
+    // UNC paths (Windows shares)
+    QString path = QDir::fromNativeSeparators( dbFileInfo.absoluteFilePath() );
+    if (path.startsWith("//")) return true;
+
+    QStorageInfo storage( dbFileInfo.absolutePath() );
+    if (!storage.isValid()) return false;
+
+    const QString fsType = QString::fromUtf8( storage.fileSystemType() ).toLower();
+    static const QStringList networkFileSystems = {
+        "nfs", "nfs4", "cifs", "smbfs", "smb", "smb2", "smb3", "afpfs", "webdav", "davfs", "9p", "fuse.sshfs", "ncpfs"
+    };
+    if (networkFileSystems.contains(fsType)) return true;
+
+    // Windows mapped network drives report the file system of the remote host,
+    // but their device is a UNC path
+    const QString device = QDir::fromNativeSeparators( QString::fromUtf8( storage.device() ) );
+    if (device.startsWith("//")) return true;
+
+    return false;
+}
+
+void LocalDataInterface::checkpoint()
+{
+    if (m_dataFile == "") return;
+    if (m_storageProfile == CompatibleStorage) return;
+    query( "PRAGMA wal_checkpoint(TRUNCATE);" );
+}
+
+bool LocalDataInterface::updateIndexes(QSqlDatabase db)
+{
+    ProgressManager *pm = ProgressManager::instance();
+    pm->setText(tr("Indexing the database..."));
+
+    QSqlQuery qry = QSqlQuery(db);
+
+    QStringList tables;
+    qry.exec("SELECT name FROM sqlite_master WHERE type = 'table' AND name LIKE 'Ram%';");
+    while (qry.next()) tables << qry.value(0).toString();
+
+    bool ok = true;
+    bool generatedColumns = true;
+
+    foreach(QString table, tables)
+    {
+        if (!indexTable(db, table, generatedColumns)) ok = false;
+    }
+
+    // Let the query planner know about the new indexes
+    qry.exec("ANALYZE;");
+
+    return ok;
+}
+
+bool LocalDataInterface::indexTable(QSqlDatabase db, const QString &table, bool &generatedColumns)
+{
+    QSqlQuery qry = QSqlQuery(db);
+    bool ok = true;
+
+    // Used by the sync and the clean up
+    QStringList indexes;
+    indexes << "CREATE INDEX IF NOT EXISTS \"%1_modified\" ON \"%1\" (\"modified\");";
+    indexes << "CREATE INDEX IF NOT EXISTS \"%1_removed\" ON \"%1\" (\"removed\", \"modified\");";
+    foreach(QString q, indexes)
+    {
+        if (qry.exec(q.arg(table))) continue;
+        QString errorMessage = "Something went wrong when indexing the database.\nHere's some information:";
+        errorMessage += "\n> " + tr("Query:") + "\n" + qry.lastQuery();
+        errorMessage += "\n> " + tr("Database Error:") + "\n" + qry.lastError().databaseText();
+        errorMessage += "\n> " + tr("Driver Error:") + "\n" + qry.lastError().driverText();
+        LocalDataInterface::instance()->log(errorMessage, DuQFLog::Critical);
+        ok = false;
+    }
+
+    // Generated columns for the JSON keys used as filters
+    if (!generatedColumns) return ok;
+    QStringList keys = tableDescriptor(table).jsonKeys;
+    if (keys.isEmpty()) return ok;
+
+    // Existing columns (table_xinfo lists the generated ones too)
+    QSet<QString> columns;
+    qry.exec(QString("PRAGMA table_xinfo(\"%1\");").arg(table));
+    while (qry.next()) columns << qry.value(1).toString();
+
+    foreach(QString key, keys)
+    {
+        QString column = jsonColumn(key);
+        if (!columns.contains(column))
+        {
+            // json_valid prevents a malformed object from breaking the whole table
+            QString q = "ALTER TABLE \"%1\" ADD COLUMN \"%2\" TEXT "
+                        "GENERATED ALWAYS AS ( CASE WHEN json_valid(\"data\") THEN json_extract(\"data\", '$.%3') END ) VIRTUAL;";
+            if (!qry.exec(q.arg(table, column, key)))
+            {
+                LocalDataInterface::instance()->log(tr("This version of SQLite can't generate columns from JSON data, "
+                                                       "the data will be filtered without indexes.\n") + qry.lastError().databaseText(),
+                                                    DuQFLog::Information);
+                generatedColumns = false;
+                break;
+            }
+        }
+        QString q = "CREATE INDEX IF NOT EXISTS \"%1_%2\" ON \"%1\" (\"%2\");";
+        qry.exec(q.arg(table, column));
+    }
+
+    return ok;
+}
+
+QString LocalDataInterface::jsonColumn(const QString &key)
+{
+    return "json_" + key;
+}
+
+void LocalDataInterface::loadJsonColumns()
+{
+    m_jsonColumns.clear();
+    if (m_dataFile == "") return;
+
+    for (const TableDescriptor &t: tableDescriptors())
+    {
+        if (t.jsonKeys.isEmpty()) continue;
+
+        QSqlQuery qry = query( QString("PRAGMA table_xinfo(\"%1\");").arg(t.name) );
+        QSet<QString> columns;
+        while (qry.next())
+        {
+            QString column = qry.value(1).toString();
+            if (column.startsWith("json_")) columns << column.mid(5);
+        }
+        if (!columns.isEmpty()) m_jsonColumns.insert(t.name, columns);
+    }
+}
+
+bool LocalDataInterface::deleteRows(QSqlDatabase db, const QString &table, const QStringList &uuids, const QString &condition, bool showProgress)
+{
+    if (uuids.isEmpty()) return true;
+
+    // Keep below the SQLite limit of bound values (999 before 3.32)
+    const int chunkSize = 500;
+
+    ProgressManager *pm = nullptr;
+    if (showProgress)
+    {
+        pm = ProgressManager::instance();
+        pm->addToMaximum( (uuids.count() + chunkSize - 1) / chunkSize );
+    }
+
+    QSqlQuery qry = QSqlQuery(db);
+    qry.exec("SAVEPOINT deleteRows;");
+
+    bool ok = true;
+    QString extra = condition == "" ? "" : " AND ( " + condition + " )";
+
+    for (int i = 0; i < uuids.count(); i += chunkSize)
+    {
+        QStringList chunk = uuids.mid(i, chunkSize);
+
+        QStringList placeholders;
+        for (int j = 0; j < chunk.count(); j++) placeholders << "?";
+
+        QString q = "DELETE FROM \"%1\" WHERE `uuid` IN ( %2 )%3;";
+        qry.prepare( q.arg(table, placeholders.join(", "), extra) );
+        foreach(QString uuid, chunk) qry.addBindValue(uuid);
+
+        if (!qry.exec())
+        {
+            QString errorMessage = "Something went wrong when deleting the data.\nHere's some information:";
+            errorMessage += "\n> " + tr("Query:") + "\n" + qry.lastQuery();
+            errorMessage += "\n> " + tr("Database Error:") + "\n" + qry.lastError().databaseText();
+            errorMessage += "\n> " + tr("Driver Error:") + "\n" + qry.lastError().driverText();
+            LocalDataInterface::instance()->log(errorMessage, DuQFLog::Critical);
+            ok = false;
+            break;
+        }
+
+        if (pm) pm->increment();
+    }
+
+    if (ok) qry.exec("RELEASE SAVEPOINT deleteRows;");
+    else
+    {
+        qry.exec("ROLLBACK TO SAVEPOINT deleteRows;");
+        qry.exec("RELEASE SAVEPOINT deleteRows;");
+    }
+
+    return ok;
+}
+
 void LocalDataInterface::autoCleanDB(QSqlDatabase db)
 {
     ProgressManager *pm = ProgressManager::instance();
@@ -1388,22 +1781,7 @@ void LocalDataInterface::autoCleanDB(QSqlDatabase db)
     qDebug() << "From " << updateData.count() << " entries to update with the project info.";
 
     // Remove uuids without project
-    // Split in 250 rows at once
-    if (!uuidsToRemove.isEmpty())
-    {
-        // Split by 250 rows at a time
-        while (!uuidsToRemove.isEmpty())
-        {
-            QString condition = " `uuid` = '" + uuidsToRemove.takeLast() + "' ";
-            for (int i = 0; i < 250; i++)
-            {
-                if (uuidsToRemove.isEmpty()) break;
-                condition += " OR `uuid` = '" + uuidsToRemove.takeLast() + "' ";
-            }
-
-            qry.exec("DELETE FROM 'RamScheduleEntry' WHERE " + condition );
-        }
-    }
+    deleteRows(db, "RamScheduleEntry", uuidsToRemove, "", true);
 
     // Set the new data
     if (!updateData.isEmpty())
@@ -1533,7 +1911,8 @@ void LocalDataInterface::autoCleanDB(QSqlDatabase db)
 
     // === Vacuum ===
 
-    qry.exec("VACUUM;");
+    // The full vacuum is left to the maintenance, when idle
+    incrementalVacuum(db);
 
     StateManager::i()->setState(previousState);
 }
@@ -1552,6 +1931,17 @@ QSqlQuery LocalDataInterface::query(QString q) const
     qDebug() << ">>>";
 #endif
 
+#ifdef QT_DEBUG
+    // The schema is verified when opening the file: there should not be any DDL after that
+    if (q.startsWith("CREATE", Qt::CaseInsensitive) || q.startsWith("ALTER", Qt::CaseInsensitive) || q.startsWith("DROP", Qt::CaseInsensitive))
+    {
+        m_ddlCount++;
+        qDebug().noquote() << "DDL after opening the database (" << m_ddlCount << "):" << q;
+    }
+#endif
+
+    if (deferWrite(q)) return qry;
+
     if (!qry.exec(q))
     {
         QString errorMessage = "Something went wrong when saving the data.\nHere's some information:";
@@ -1565,23 +1955,499 @@ QSqlQuery LocalDataInterface::query(QString q) const
     //return m_querier->query(q);
 }
 
+QSqlQuery LocalDataInterface::preparedQuery(const QString &q)
+{
+    // QSqlQuery is implicitly shared:
+    // the returned copy uses the same prepared statement as the cached one
+    QHash<QString, QSqlQuery>::const_iterator it = m_preparedQueries.constFind(q);
+    if (it != m_preparedQueries.constEnd()) return it.value();
+
+    QSqlDatabase db = QSqlDatabase::database("localdata");
+    QSqlQuery qry = QSqlQuery(db);
+    // We only read forward, this saves SQLite from caching the results
+    qry.setForwardOnly(true);
+
+    if (!qry.prepare(q))
+    {
+        QString errorMessage = "Something went wrong when preparing a query.\nHere's some information:";
+        errorMessage += "\n> " + tr("Query:") + "\n" + q;
+        errorMessage += "\n> " + tr("Database Error:") + "\n" + qry.lastError().databaseText();
+        errorMessage += "\n> " + tr("Driver Error:") + "\n" + qry.lastError().driverText();
+        log(errorMessage, DuQFLog::Critical);
+        // Don't cache it, the table may exist later
+        return qry;
+    }
+
+    m_preparedQueries.insert(q, qry);
+    return qry;
+}
+
+bool LocalDataInterface::execPrepared(QSqlQuery &qry) const
+{
+    if (m_dataFile =="") return false;
+
+#ifdef DEBUG_DATA
+    qDebug() << "<<< SQLITE Prepared Query";
+    qDebug().noquote() << qry.lastQuery();
+    qDebug() << qry.boundValues();
+    qDebug() << ">>>";
+#endif
+
+    if (deferWrite(qry.lastQuery(), qry.boundValues())) return true;
+
+    if (!qry.exec())
+    {
+        QString errorMessage = "Something went wrong when saving the data.\nHere's some information:";
+        errorMessage += "\n> " + tr("Query:") + "\n" + qry.lastQuery();
+        errorMessage += "\n> " + tr("Database Error:") + "\n" + qry.lastError().databaseText();
+        errorMessage += "\n> " + tr("Driver Error:") + "\n" + qry.lastError().driverText();
+        log(errorMessage, DuQFLog::Critical);
+        return false;
+    }
+
+    return true;
+}
+
+bool LocalDataInterface::deferWrite(const QString &q, const QMap<QString, QVariant> &values) const
+{
+    if (!m_savingSync && !m_vacuuming) return false;
+
+    QString statement = q.trimmed();
+    if (statement.startsWith("SELECT", Qt::CaseInsensitive) || statement.startsWith("PRAGMA", Qt::CaseInsensitive)) return false;
+
+    LocalDataWorker *worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker, q, values]() {
+        worker->execWrite(q, values);
+    }, Qt::QueuedConnection);
+    return true;
+}
+
+void LocalDataInterface::clearPreparedQueries()
+{
+    QHash<QString, QSqlQuery>::iterator it = m_preparedQueries.begin();
+    while (it != m_preparedQueries.end())
+    {
+        it.value().finish();
+        it++;
+    }
+    m_preparedQueries.clear();
+}
+
 void LocalDataInterface::vacuum()
 {
+    // Needs a vacuum to be applied to an existing file
+    query( "PRAGMA auto_vacuum = INCREMENTAL;" );
     QString q = "VACUUM;";
     query( q );
 }
 
-void LocalDataInterface::createTable(const QString &tableName)
+void LocalDataInterface::incrementalVacuum(QSqlDatabase db)
+{
+    QSqlQuery qry = QSqlQuery(db);
+    qry.exec("PRAGMA auto_vacuum;");
+    // 2 is incremental
+    if (!qry.first() || qry.value(0).toInt() != 2) return;
+    qry.exec("PRAGMA incremental_vacuum;");
+    // Run the whole statement, it frees one page per step
+    while (qry.next()) {}
+}
+
+bool LocalDataInterface::needsVacuum(QSqlDatabase db)
+{
+    QSqlQuery qry = QSqlQuery(db);
+
+    qint64 pageCount = 0;
+    qint64 freeCount = 0;
+    int autoVacuum = 0;
+    qry.exec("PRAGMA page_count;");
+    if (qry.first()) pageCount = qry.value(0).toLongLong();
+    qry.exec("PRAGMA freelist_count;");
+    if (qry.first()) freeCount = qry.value(0).toLongLong();
+    qry.exec("PRAGMA auto_vacuum;");
+    if (qry.first()) autoVacuum = qry.value(0).toInt();
+    qry.finish();
+
+    if (pageCount == 0) return false;
+
+    // At least 20% and 1000 pages (4 MB with the default page size) to free,
+    // or a small file (less than 10000 pages) which has never been switched to incremental auto vacuum
+    double ratio = double(freeCount) / double(pageCount);
+    bool fragmented = ratio >= 0.2 && freeCount >= 1000;
+    bool switchMode = autoVacuum != 2 && pageCount < 10000;
+    bool vacuum = fragmented || switchMode;
+
+    QString decision = tr("Database maintenance: %1 free pages out of %2 (%3%), auto vacuum mode: %4. ")
+            .arg(freeCount)
+            .arg(pageCount)
+            .arg(int(ratio*100))
+            .arg(autoVacuum);
+    if (vacuum) decision += tr("Running a full vacuum.");
+    else decision += tr("No full vacuum needed.");
+    LocalDataInterface::instance()->log(decision, DuQFLog::Debug);
+
+    return vacuum;
+}
+
+void LocalDataInterface::maintain()
+{
+    if (m_dataFile == "") return;
+
+    // Not now, try later
+    if (StateManager::i()->state() != StateManager::Idle || m_savingSync || m_vacuuming || m_transactionDepth > 0)
+    {
+        m_maintenanceTimer->start();
+        return;
+    }
+
+    QSqlDatabase db = QSqlDatabase::database("localdata");
+
+    if (!needsVacuum(db))
+    {
+        incrementalVacuum(db);
+        return;
+    }
+
+    // Without WAL, the rewrite would lock the file for the whole vacuum, even for reading
+    if (m_storageProfile == CompatibleStorage)
+    {
+        log(tr("The database should be vacuumed, but it can't be done in the background with the compatible storage profile."), DuQFLog::Debug);
+        incrementalVacuum(db);
+        return;
+    }
+
+    // Rewrite the file in the storage thread;
+    // the writes from here are run there after the vacuum
+    m_vacuuming = true;
+    StateManager::i()->setState(StateManager::WritingDataBase);
+    LocalDataWorker *worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker]() {
+        worker->vacuum();
+    }, Qt::QueuedConnection);
+}
+
+void LocalDataInterface::emitInserted(const QString &uuid, const QString &data, const QString &modificationDate, const QString &table)
+{
+    if (m_transactionDepth == 0)
+    {
+        emit inserted(uuid, data, modificationDate, table);
+        return;
+    }
+
+    TableChange c;
+    c.type = TableChange::Inserted;
+    c.uuid = uuid;
+    c.data = data;
+    c.modified = modificationDate;
+    c.table = table;
+    m_pendingChanges << c;
+}
+
+void LocalDataInterface::emitDataChanged(const QString &uuid, const QString &data, const QString &modificationDate, const QString &table)
+{
+    if (m_transactionDepth == 0)
+    {
+        emit dataChanged(uuid, data, modificationDate, table);
+        return;
+    }
+
+    // Update the previous change of the same object if any
+    const QString key = table % "/" % uuid;
+    int i = m_pendingDataChanges.value(key, -1);
+    if (i >= 0)
+    {
+        m_pendingChanges[i].data = data;
+        m_pendingChanges[i].modified = modificationDate;
+        return;
+    }
+
+    TableChange c;
+    c.type = TableChange::DataChanged;
+    c.uuid = uuid;
+    c.data = data;
+    c.modified = modificationDate;
+    c.table = table;
+    m_pendingDataChanges.insert(key, m_pendingChanges.count());
+    m_pendingChanges << c;
+}
+
+void LocalDataInterface::emitRemoved(const QString &uuid, const QString &table)
+{
+    if (m_transactionDepth == 0)
+    {
+        emit removed(uuid, table);
+        return;
+    }
+
+    TableChange c;
+    c.type = TableChange::Removed;
+    c.uuid = uuid;
+    c.table = table;
+    m_pendingChanges << c;
+}
+
+void LocalDataInterface::flushPendingChanges()
+{
+    // Swap first, the listeners may write again
+    QVector<TableChange> changes;
+    changes.swap(m_pendingChanges);
+    m_pendingDataChanges.clear();
+    m_savedPendingChanges.clear();
+
+    if (changes.isEmpty()) return;
+
+    m_flushingTransaction = true;
+
+    for (const TableChange &c: qAsConst(changes))
+    {
+        switch(c.type)
+        {
+        case TableChange::Inserted:
+            emit inserted(c.uuid, c.data, c.modified, c.table);
+            break;
+        case TableChange::DataChanged:
+            emit dataChanged(c.uuid, c.data, c.modified, c.table);
+            break;
+        case TableChange::Removed:
+            emit removed(c.uuid, c.table);
+            break;
+        case TableChange::AvailabilityChanged:
+            emit availabilityChanged(c.uuid, c.available);
+            break;
+        case TableChange::InsertedRemoved:
+        case TableChange::Deleted:
+            break;
+        }
+    }
+
+    m_flushingTransaction = false;
+
+    emit transactionCommitted();
+}
+
+void LocalDataInterface::discardPendingChanges()
+{
+    QVector<TableChange> changes;
+    changes.swap(m_pendingChanges);
+    m_pendingDataChanges.clear();
+    QSet<QString> saved;
+    saved.swap(m_savedPendingChanges);
+
+    // The caches were updated with the rolled back writes
+    for (const TableChange &c: qAsConst(changes))
+    {
+        m_dataCache.remove(c.table % "/" % c.uuid);
+        m_uuidIndex.remove(c.table);
+    }
+
+    QSet<QString> uuids;
+    for (TableChange c: qAsConst(changes))
+    {
+        // Saved by the storage thread, these are not rolled back
+        if (saved.contains(c.table % "/" % c.uuid))
+        {
+            if (c.type == TableChange::Inserted || c.type == TableChange::DataChanged)
+                c.data = objectData(c.uuid, c.table);
+            m_pendingChanges << c;
+        }
+        uuids.insert(c.uuid);
+    }
+
+    flushPendingChanges();
+
+    // The loaded objects may still have the rolled back data
+    for (const QString &uuid: qAsConst(uuids))
+    {
+        RamAbstractObject *o = RamObjectRegistry::object(uuid);
+        if (o) o->revertData();
+    }
+}
+
+void LocalDataInterface::openWorkerFile()
+{
+    if (!m_workerThread.isRunning()) return;
+
+    LocalDataWorker *worker = m_worker;
+    QString file = m_dataFile;
+    StorageProfile profile = m_storageProfile;
+    QMetaObject::invokeMethod(m_worker, [worker, file, profile]() {
+        worker->openFile(file, profile);
+    }, Qt::BlockingQueuedConnection);
+}
+
+void LocalDataInterface::closeWorkerFile()
+{
+    if (!m_workerThread.isRunning()) return;
+
+    // Queued after any pending work, so this waits for it to finish
+    LocalDataWorker *worker = m_worker;
+    QMetaObject::invokeMethod(m_worker, [worker]() {
+        worker->closeFile();
+    }, Qt::BlockingQueuedConnection);
+}
+
+void LocalDataInterface::journalChange(const QString &uuid, const QString &table)
+{
+    // Not idle
+    m_maintenanceTimer->start();
+
+    // Replace to get a new id: a change already being pushed must be pushed again
+    QSqlQuery qry = preparedQuery( "INSERT OR REPLACE INTO _Changes (tableName, uuid) VALUES (:tableName, :uuid);" );
+    qry.bindValue(":tableName", table);
+    qry.bindValue(":uuid", uuid);
+    execPrepared( qry );
+
+    emit changeJournaled();
+}
+
+void LocalDataInterface::cacheData(const QString &uuid, const QString &data, const QString &table)
+{
+    m_dataCache.insert(table % "/" % uuid, new QString(data), data.size());
+}
+
+const QHash<QString, bool> &LocalDataInterface::uuidIndex(const QString &table)
+{
+    if (!CACHE_LOCAL_DATA) m_uuidIndex.remove(table);
+
+    auto it = m_uuidIndex.constFind(table);
+    if (it != m_uuidIndex.constEnd()) return it.value();
+
+    QString q = "SELECT uuid, removed FROM \"%1\" ;";
+    QSqlQuery qry = preparedQuery( q.arg(table) );
+    execPrepared( qry );
+
+    QHash<QString, bool> index;
+    while (qry.next()) index.insert(qry.value(0).toString(), qry.value(1).toBool());
+    qry.finish();
+
+    return m_uuidIndex.insert(table, index).value();
+}
+
+void LocalDataInterface::indexUuid(const QString &table, const QString &uuid, bool removed, bool onlyNew)
+{
+    // Not indexed yet: it will be read from the database when needed
+    auto it = m_uuidIndex.find(table);
+    if (it == m_uuidIndex.end()) return;
+    if (onlyNew && it.value().contains(uuid)) return;
+    it.value().insert(uuid, removed);
+}
+
+void LocalDataInterface::unindexUuid(const QString &table, const QString &uuid)
+{
+    auto it = m_uuidIndex.find(table);
+    if (it == m_uuidIndex.end()) return;
+    it.value().remove(uuid);
+}
+
+void LocalDataInterface::workerProgress(QString text)
+{
+    ProgressManager *pm = ProgressManager::instance();
+    pm->setText(text);
+    pm->increment();
+}
+
+void LocalDataInterface::workerChangesSaved(QVector<TableChange> changes)
+{
+    StateManager::i()->setState(StateManager::LoadingDataBase);
+
+    // Emit the whole batch at once, like a transaction;
+    // or with the current transaction if there's one
+    bool flush = m_transactionDepth == 0;
+    m_transactionDepth++;
+
+    for (const TableChange &c: qAsConst(changes))
+    {
+        if (!flush) m_savedPendingChanges.insert(c.table % "/" % c.uuid);
+
+        switch(c.type)
+        {
+        case TableChange::Inserted:
+            indexUuid(c.table, c.uuid, false);
+            cacheData(c.uuid, c.data, c.table);
+            emitInserted(c.uuid, c.data, c.modified, c.table);
+            break;
+        case TableChange::DataChanged:
+            cacheData(c.uuid, c.data, c.table);
+            emitDataChanged(c.uuid, c.data, c.modified, c.table);
+            break;
+        case TableChange::Removed:
+            emitRemoved(c.uuid, c.table);
+            break;
+        case TableChange::AvailabilityChanged:
+            indexUuid(c.table, c.uuid, !c.available);
+            m_pendingChanges << c;
+            break;
+        case TableChange::InsertedRemoved:
+            indexUuid(c.table, c.uuid, true);
+            break;
+        case TableChange::Deleted:
+            unindexUuid(c.table, c.uuid);
+            break;
+        }
+    }
+
+    m_transactionDepth--;
+    if (flush) flushPendingChanges();
+
+    StateManager::i()->setState(StateManager::WritingDataBase);
+}
+
+void LocalDataInterface::workerVacuumed()
+{
+    // Wait for the deferred writes, the next ones must run after them
+    if (m_workerThread.isRunning()) QMetaObject::invokeMethod(m_worker, []() {}, Qt::BlockingQueuedConnection);
+    m_vacuuming = false;
+    StateManager::i()->setState(StateManager::Idle);
+}
+
+void LocalDataInterface::workerSyncSaved(bool ok)
+{
+    // Wait for the deferred writes, the next ones must run after them
+    if (m_workerThread.isRunning()) QMetaObject::invokeMethod(m_worker, []() {}, Qt::BlockingQueuedConnection);
+    m_savingSync = false;
+    StateManager::i()->setState(m_stateBeforeSync);
+    emit syncFinished(!ok);
+}
+
+bool LocalDataInterface::createTable(QSqlDatabase db, const TableDescriptor &table)
 {
     QString q = "CREATE TABLE IF NOT EXISTS \"%1\" ( "
                 "\"id\"	INTEGER NOT NULL UNIQUE, "
                 "\"uuid\"	TEXT NOT NULL UNIQUE, "
                 "\"data\"	TEXT NOT NULL DEFAULT '{}', "
                 "\"modified\"	timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP, "
-                "\"removed\"	INTEGER NOT NULL DEFAULT 0, "
-                "PRIMARY KEY(\"id\" AUTOINCREMENT) "
+                "\"removed\"	INTEGER NOT NULL DEFAULT 0, ";
+    if (table.hasUserName) q += "\"userName\"	TEXT NOT NULL DEFAULT 'NEW', ";
+    q +=        "PRIMARY KEY(\"id\" AUTOINCREMENT) "
                 ")";
-    query( q.arg( tableName ) );
+
+    QSqlQuery qry = QSqlQuery(db);
+    if (qry.exec( q.arg( table.name ) ))
+    {
+        bool generatedColumns = true;
+        return indexTable(db, table.name, generatedColumns);
+    }
+
+    QString errorMessage = "Something went wrong when creating a table.\nHere's some information:";
+    errorMessage += "\n> " + tr("Query:") + "\n" + qry.lastQuery();
+    errorMessage += "\n> " + tr("Database Error:") + "\n" + qry.lastError().databaseText();
+    errorMessage += "\n> " + tr("Driver Error:") + "\n" + qry.lastError().driverText();
+    LocalDataInterface::instance()->log(errorMessage, DuQFLog::Critical);
+    return false;
+}
+
+void LocalDataInterface::verifySchema(QSqlDatabase db)
+{
+    QSqlQuery qry = QSqlQuery(db);
+    QSet<QString> existingTables;
+    qry.exec("SELECT name FROM sqlite_master WHERE type = 'table';");
+    while (qry.next()) existingTables << qry.value(0).toString();
+
+    for (const TableDescriptor &t: tableDescriptors())
+    {
+        if (existingTables.contains(t.name)) continue;
+        LocalDataInterface::instance()->log(tr("Adding the missing table %1 to the database.").arg(t.name), DuQFLog::Debug);
+        createTable(db, t);
+    }
 }
 
 const QHash<QString, QSet<QString> > &LocalDataInterface::deletedUuids() const
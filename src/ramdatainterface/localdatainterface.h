@@ -4,14 +4,23 @@
 #include <QSqlQuery>
 #include <QSqlError>
 #include <QStringBuilder>
+#include <QCache>
+#include <QThread>
+#include <QTimer>
 
 #include "duqf-utils/duqflogger.h"
+#include "enums.h"
 #include "datastruct.h"
+#include "statemanager.h"
+
+class LocalDataWorker;
 
 class LocalDataInterface : public DuQFLoggerObject
 {
     Q_OBJECT
 
+    friend class LocalDataWorker;
+
 public:
     /**
      * @brief instance returns the unique instance of RamServerInterface.
@@ -34,7 +43,7 @@ public:
     QSet<QString> tableUuids(QString table, bool includeRemoved = false);
     // Returns a vector instead of set: tabledata may be sorted later
     QVector<QStringList> tableData(QString table, QHash<QString, QStringList> filters = QHash<QString, QStringList>(), bool includeRemoved = false);
-    bool contains(QString uuid, QString table, bool includeRemoved = false);
+    bool contains(const QString &uuid, const QString &table, bool includeRemoved = false);
     QMap<QString, QString> modificationDates(QString table);
 
     void createObject(QString uuid, QString table, QString data);
@@ -62,16 +71,54 @@ public:
     const QString &dataFile() const;
     ServerConfig setDataFile(const QString &file);
 
+    /**
+     * @brief getSync Lists the rows to push to the server.
+     * When not a full sync, only the rows in the local changes journal are listed;
+     * the journal is truncated when the server has committed them (when sync() is called).
+     */
     SyncData getSync(bool fullSync=true);
-    void saveSync(SyncData syncData);
-    void deleteData(SyncData syncData);
+    // True while the storage thread is saving the data pulled from the server
+    bool isSavingSync() const;
+    /**
+     * @brief resumePull Lists the pages already staged by a previous (interrupted) sync, which can be kept.
+     * Pages are kept only if their table has the same page and row counts in the new fetch;
+     * everything else is removed from the staging tables.
+     * @return The staged pages, by table
+     */
+    QHash<QString, QSet<int>> resumePull(const QSet<TableFetchData> &tables);
 
     QString currentUserUuid();
     void setCurrentUserUuid(QString uuid);
 
+    /**
+     * @brief tableDescriptors describes the data tables (the Ram* tables).
+     * It's read from the template database the first time it's needed, then kept in memory.
+     */
+    static const QVector<TableDescriptor> &tableDescriptors();
+    static TableDescriptor tableDescriptor(const QString &name);
+    // Checks the name is one of the data tables; the names sent by the server must be checked before being used in SQL
+    static bool isDataTable(const QString &name);
     QStringList tableNames();
     QVector<QStringList> users();
 
+    // TRANSACTIONS //
+
+    /**
+     * @brief beginTransaction Groups all the following writes in a single SQLite transaction.
+     * Calls can be nested, only the outermost commitTransaction() actually commits.
+     * Until then, the inserted, dataChanged and removed signals are held back;
+     * they're emitted at commit time, once per object.
+     * If the commit fails, they're dropped and the affected objects reload their data from the database.
+     */
+    void beginTransaction();
+    void commitTransaction();
+    bool isInTransaction() const;
+    /**
+     * @brief isFlushingTransaction is true while the signals held back by a transaction are emitted.
+     * Listeners can use it to wait for transactionCommitted() before updating.
+     */
+    bool isFlushingTransaction() const;
+
     // MAINTENANCE //
     QString cleanDataBase(int deleteDataOlderThan = -1);
     bool undoClean();
@@ -79,18 +126,31 @@ public:
     const QHash<QString, QSet<QString> > &deletedUuids() const;
 
 public slots:
+    /**
+     * @brief sync Saves the data pulled from the server in the storage thread.
+     * The changes are emitted table by table, and syncFinished() when it's done.
+     */
     void sync(SyncData data, QString serverUuid = "");
+    /**
+     * @brief stagePulledPage Saves a page pulled from the server, in the storage thread.
+     * The staged pages are merged by sync(), when its data is staged.
+     */
+    void stagePulledPage(TableFetchData table, int page, QSet<TableRow> rows, QStringList deletedUuids);
 
 signals:
     void dataResetCommon();
     void dataResetProject();
     void ramsesPathChanged(QString);
     // Sync result
-    void syncFinished();
+    void syncFinished(bool withError);
     void dataChanged(const QString &uuid, const QString &data, const QString &modificationDate, const QString &table);
     void availabilityChanged(QString,bool);
     void inserted(const QString &uuid, const QString &data, const QString &modificationDate, const QString &table);
     void removed(const QString &uuid, const QString &table);
+    // Emitted after the signals held back by a transaction have been emitted
+    void transactionCommitted();
+    // Emitted when a local change has been added to the journal, and has to be pushed
+    void changeJournaled();
 
 protected:
     static LocalDataInterface *_instance;
@@ -98,6 +158,15 @@ protected:
 private slots:
     void logError(QString err);
     void quit();
+    // Applies the storage profile from the settings to the current database
+    void storageProfileChanged();
+    // Results from the storage thread
+    void workerProgress(QString text);
+    void workerChangesSaved(QVector<TableChange> changes);
+    void workerSyncSaved(bool ok);
+    void workerVacuumed();
+    // Runs the file maintenance when the application is idle
+    void maintain();
 
 private:
     /**
@@ -111,23 +180,156 @@ private:
 
     static void autoCleanDB(QSqlDatabase db);
 
+    /**
+     * @brief deleteRows Deletes rows by uuid, with bound IN (...) chunks, inside a savepoint
+     * (so it can be used in or out of a transaction).
+     * @param condition An additional condition the rows must satisfy to be deleted
+     * @param showProgress Increments the progress bar for each chunk. Must be false if not in the GUI thread.
+     * @return false if a chunk could not be deleted; nothing is deleted then
+     */
+    static bool deleteRows(QSqlDatabase db, const QString &table, const QStringList &uuids, const QString &condition = "", bool showProgress = false);
+    // Reads the data of a table, using the generated columns available to filter it
+    static QVector<QStringList> readTableData(QSqlDatabase db, const QString &table, const QHash<QString, QStringList> &filters, bool includeRemoved, const QSet<QString> &jsonColumns);
+
+    /**
+     * @brief updateIndexes adds the indexes on the modified and removed columns,
+     * and indexed generated columns for the JSON keys used to filter the tables.
+     * Generated columns are skipped if the SQLite library doesn't support them (< 3.31 or no JSON1).
+     * @return false if an index could not be created
+     */
+    static bool updateIndexes(QSqlDatabase db);
+    // Indexes a single table; generatedColumns is set to false if they're not supported
+    static bool indexTable(QSqlDatabase db, const QString &table, bool &generatedColumns);
+    /**
+     * @brief SCHEMA_VERSION The version of the indexes and generated columns, stored in _Ramses.
+     * Increment it when they change, so that existing databases are updated.
+     */
+    static const int SCHEMA_VERSION = 1;
+    // Reads the table descriptors from the template database
+    static QVector<TableDescriptor> loadTableDescriptors();
+    // The name of the generated column for a JSON key
+    static QString jsonColumn(const QString &key);
+    // Lists the generated columns actually available in the current database
+    void loadJsonColumns();
+
+    /**
+     * @brief applyStorageProfile sets the SQLite pragmas (journal, cache, mmap...) for the profile
+     * Falls back to the compatible profile if the file is on a network file system,
+     * where WAL and memory mapping are not safe.
+     * @return The profile actually applied
+     */
+    static StorageProfile applyStorageProfile(QSqlDatabase db, const QString &dbFile, StorageProfile profile);
+    // Checks if the file is on a network file system (NFS, SMB...)
+    static bool isOnNetworkFileSystem(const QString &dbFile);
+    // Writes the WAL content back to the database file
+    void checkpoint();
+
     // Runs a query on the current database
     QSqlQuery query(QString q) const;
-    // SQLite vacuum
+    // Returns a prepared query for the current database, cached by its SQL string.
+    // Table names can't be bound, so there's one cached statement per table.
+    QSqlQuery preparedQuery(const QString &q);
+    // Runs a prepared query after its values have been bound
+    bool execPrepared(QSqlQuery &qry) const;
+    // Drops all prepared queries; must be called before the database is closed
+    void clearPreparedQueries();
+    /**
+     * @brief deferWrite While a sync is being saved or the file vacuumed, sends the writes to the storage thread,
+     * which runs them afterwards instead of waiting for its lock here.
+     * Only named placeholders are supported in the values.
+     * @return true if the write is deferred
+     */
+    bool deferWrite(const QString &q, const QMap<QString, QVariant> &values = QMap<QString, QVariant>()) const;
+    // SQLite vacuum; also switches the file to incremental auto vacuum
     void vacuum();
+    // Frees some of the unused pages, if the file is in incremental auto vacuum mode. Fast.
+    static void incrementalVacuum(QSqlDatabase db);
+    /**
+     * @brief needsVacuum Checks the fragmentation of the file (free pages / total pages)
+     * and logs the decision
+     * @return true if a full vacuum is worth rewriting the whole file
+     */
+    static bool needsVacuum(QSqlDatabase db);
+
+    // Emit the change signals, or hold them back until commit if in a transaction
+    void emitInserted(const QString &uuid, const QString &data, const QString &modificationDate, const QString &table);
+    void emitDataChanged(const QString &uuid, const QString &data, const QString &modificationDate, const QString &table);
+    void emitRemoved(const QString &uuid, const QString &table);
+    // Emits all the held back signals
+    void flushPendingChanges();
+    // Drops the held back signals of a rolled back transaction, and reloads the affected objects
+    void discardPendingChanges();
+
+    // Opens the current file in the storage thread, or closes it if there's no file.
+    // Blocks until it's done: it must be closed before the file is moved or reconfigured.
+    void openWorkerFile();
+    void closeWorkerFile();
+    // Adds the object to the journal of local changes to push with the next sync
+    void journalChange(const QString &uuid, const QString &table);
+    // Read cache
+    void cacheData(const QString &uuid, const QString &data, const QString &table);
+    /**
+     * @brief uuidIndex The uuids of a table, with their removed state.
+     * Read from the database the first time, then updated in place with each change.
+     */
+    const QHash<QString, bool> &uuidIndex(const QString &table);
+    // Updates the index if the table is already indexed; with onlyNew, an existing entry is kept as is
+    void indexUuid(const QString &table, const QString &uuid, bool removed, bool onlyNew = false);
+    void unindexUuid(const QString &table, const QString &uuid);
 
-    // Makes sure a table exists
-    // Creates if not exists
-    void createTable(const QString &tableName);
+    // Creates the table with its indexes if it doesn't exist
+    static bool createTable(QSqlDatabase db, const TableDescriptor &table);
+    // Creates all missing tables; called once when opening the file,
+    // so that reads and writes don't need to check the tables
+    static void verifySchema(QSqlDatabase db);
 
     /**
      * @brief m_dataFile The SQLite file path
      */
     QString m_dataFile;
-
-    // Cache UUIDS to check their existence faster
-    QHash<QString, QSet<QString>> m_uuids;
-    QHash<QString, QSet<QString>> m_uuidsWithoutRemoved;
+    /**
+     * @brief m_storageProfile The storage profile applied to the current file
+     */
+    StorageProfile m_storageProfile = CompatibleStorage;
+
+    // The storage thread, and the worker living there
+    QThread m_workerThread;
+    LocalDataWorker *m_worker;
+    bool m_savingSync = false;
+    bool m_vacuuming = false;
+    StateManager::State m_stateBeforeSync = StateManager::Idle;
+
+    // Fires when there's been no local change for a while, to run the maintenance
+    QTimer *m_maintenanceTimer;
+
+#ifdef QT_DEBUG
+    // Counts the DDL queries run after opening the file, should stay at 0
+    mutable int m_ddlCount = 0;
+#endif
+
+    // Cache object data read or written from here, by table + uuid
+    // Costs the size of the data, up to LOCAL_DATA_CACHE_SIZE
+    QCache<QString, QString> m_dataCache;
+
+    // UUIDS index to check their existence faster: by table, uuid -> removed
+    QHash<QString, QHash<QString, bool>> m_uuidIndex;
+
+    // The generated JSON columns available, by table
+    QHash<QString, QSet<QString>> m_jsonColumns;
+
+    // Prepared statements for the current database, by SQL string
+    QHash<QString, QSqlQuery> m_preparedQueries;
+
+    // Transactions
+    int m_transactionDepth = 0;
+    bool m_flushingTransaction = false;
+    QVector<TableChange> m_pendingChanges;
+    // Index of the pending dataChanged in m_pendingChanges, by table + uuid,
+    // to emit only the latest data for each object
+    QHash<QString, int> m_pendingDataChanges;
+    // The pending changes already saved by the storage thread, by table + uuid,
+    // which must still be emitted if the transaction is rolled back
+    QSet<QString> m_savedPendingChanges;
 
     // The UUIDS to delete when cleaning the database
     QHash<QString, QSet<QString>> m_uuidsToRemove;
@@ -0,0 +1,534 @@
+#include "localdataworker.h"
+
+#include <QElapsedTimer>
+
+#include "localdatainterface.h"
+#include "dbinterface.h"
+
+LocalDataWorker::LocalDataWorker(QObject *parent) :
+    DuQFLoggerObject("Local Data Worker", parent)
+{
+
+}
+
+void LocalDataWorker::openFile(const QString &file, StorageProfile profile)
+{
+    closeFile();
+    if (file == "") return;
+
+    // The connection belongs to the thread which creates it: this one
+    QSqlDatabase db;
+    if (QSqlDatabase::contains(m_connectionName)) db = QSqlDatabase::database(m_connectionName, false);
+    else db = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+    db.setHostName("localhost");
+    db.setDatabaseName(file);
+
+    if (!db.open())
+    {
+        log(tr("Can't open the database in the background thread.") + "\n" + db.lastError().databaseText(), DuQFLog::Critical);
+        return;
+    }
+
+    // Same options as the main connection
+    LocalDataInterface::applyStorageProfile(db, file, profile);
+
+    m_isOpen = true;
+}
+
+void LocalDataWorker::closeFile()
+{
+    if (!m_isOpen) return;
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName, false);
+    db.close();
+    m_isOpen = false;
+}
+
+void LocalDataWorker::saveSync(SyncData syncData, QString serverUuid)
+{
+    if (!m_isOpen)
+    {
+        emit syncSaved(false);
+        return;
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+
+    // Everything in a single transaction
+    db.transaction();
+
+    // Merge, and keep the changes to emit them after the commit
+    QHash<QString, QVector<TableChange>> changes;
+    if (syncData.staged)
+    {
+        // The rows have been saved page by page in the staging tables
+        QStringList tables;
+        QSqlQuery qry = query( "SELECT DISTINCT tableName FROM _PullStaging;" );
+        while (qry.next()) tables << qry.value(0).toString();
+        for (const QString &table: qAsConst(tables))
+        {
+            emit progress(tr("Merging new data in: %1").arg(table));
+            if (table == "") continue;
+            if (loadStagedIncoming(table)) changes.insert(table, mergeIncoming(table));
+        }
+
+        tables.clear();
+        qry = query( "SELECT DISTINCT tableName FROM _PullDeleted;" );
+        while (qry.next()) tables << qry.value(0).toString();
+        for (const QString &table: qAsConst(tables))
+        {
+            // Only from our own tables, the names come from the server
+            if (!LocalDataInterface::isDataTable(table)) continue;
+
+            emit progress(tr("Removing out-of-date data from: %1").arg(table));
+            QSqlQuery deletedQry(db);
+            deletedQry.prepare( "SELECT uuid FROM _PullDeleted WHERE tableName = ?;" );
+            deletedQry.addBindValue(table);
+            if (deletedQry.exec())
+            {
+                while (deletedQry.next()) changes[table] << deletedChange(table, deletedQry.value(0).toString());
+            }
+            QSqlQuery deleteQry(db);
+            deleteQry.prepare( QString("DELETE FROM \"%1\" WHERE uuid IN (SELECT uuid FROM _PullDeleted WHERE tableName = ?);").arg(table) );
+            deleteQry.addBindValue(table);
+            if (!deleteQry.exec())
+                log(tr("Can't remove the out-of-date data.") + "\n" + deleteQry.lastError().databaseText(), DuQFLog::Critical);
+        }
+
+        // Merged in the same transaction
+        clearStaging();
+    }
+    else
+    {
+        QHashIterator<QString, QSet<TableRow>> i(syncData.tables);
+        while (i.hasNext()) {
+            i.next();
+            emit progress(tr("Merging new data in: %1").arg(i.key()));
+            if (i.key() == "") continue;
+            changes.insert(i.key(), mergeRows(i.key(), i.value()));
+        }
+
+        // Deletions
+        QHashIterator<QString, QStringList> d(syncData.deletedUuids);
+        while (d.hasNext()) {
+            d.next();
+            if (!LocalDataInterface::isDataTable(d.key())) continue;
+            emit progress(tr("Removing out-of-date data from: %1").arg(d.key()));
+            deleteRows(d.key(), d.value());
+            for (const QString &uuid: d.value()) changes[d.key()] << deletedChange(d.key(), uuid);
+        }
+    }
+
+    // Save sync date
+    emit progress(tr("Cleaning..."));
+
+    // (a sync of only some tables doesn't have a date)
+    if (syncData.syncDate != "")
+    {
+        query( "DELETE FROM _Sync;" );
+        QString q = "INSERT INTO _Sync ( lastSync, uuid ) VALUES ( '%1', '%2' );";
+        query( q.arg( syncData.syncDate, serverUuid ) );
+    }
+
+    if (!db.commit())
+    {
+        log(tr("Can't save the data from the server.") + "\n" + db.lastError().databaseText(), DuQFLog::Critical);
+        db.rollback();
+        emit syncSaved(false);
+        return;
+    }
+
+    // Now that the data can be read, send the changes, one batch per table
+    QHashIterator<QString, QVector<TableChange>> c(changes);
+    while (c.hasNext()) {
+        c.next();
+        if (!c.value().isEmpty()) emit changesSaved(c.value());
+    }
+
+    emit syncSaved(true);
+}
+
+void LocalDataWorker::stagePage(TableFetchData fetchData, int page, QSet<TableRow> rows, QStringList deletedUuids)
+{
+    const QString table = fetchData.name;
+    if (!m_isOpen || table == "") return;
+
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+    db.transaction();
+
+    QVariantList tableNames, uuids, datas, modifieds, removeds, userNames, pages;
+    for (const TableRow &row: qAsConst(rows))
+    {
+        if (row.uuid == "") continue;
+        tableNames << table;
+        uuids << row.uuid;
+        datas << storedData(table, row);
+        modifieds << row.modified;
+        removeds << row.removed;
+        userNames << row.userName;
+        pages << page;
+    }
+
+    QSqlQuery qry(db);
+
+    // A row found in several pages: the last page wins
+    if (!uuids.isEmpty())
+    {
+        qry.prepare( "INSERT INTO _PullStaging (tableName, uuid, data, modified, removed, userName, page) "
+                     "VALUES (?, ?, ?, ?, ?, ?, ?) "
+                     "ON CONFLICT(tableName, uuid) DO UPDATE SET "
+                     "`data` = excluded.data, `modified` = excluded.modified, `removed` = excluded.removed, "
+                     "`userName` = excluded.userName, `page` = excluded.page "
+                     "WHERE excluded.page >= _PullStaging.page;" );
+        qry.addBindValue(tableNames);
+        qry.addBindValue(uuids);
+        qry.addBindValue(datas);
+        qry.addBindValue(modifieds);
+        qry.addBindValue(removeds);
+        qry.addBindValue(userNames);
+        qry.addBindValue(pages);
+        if (!qry.execBatch())
+            log(tr("Can't save the data from the server.") + "\n" + qry.lastError().databaseText(), DuQFLog::Critical);
+    }
+
+    if (!deletedUuids.isEmpty())
+    {
+        QVariantList deletedTables, deleted;
+        for (const QString &uuid: qAsConst(deletedUuids))
+        {
+            deletedTables << table;
+            deleted << uuid;
+        }
+        qry.prepare( "INSERT OR IGNORE INTO _PullDeleted (tableName, uuid) VALUES (?, ?);" );
+        qry.addBindValue(deletedTables);
+        qry.addBindValue(deleted);
+        if (!qry.execBatch())
+            log(tr("Can't save the data from the server.") + "\n" + qry.lastError().databaseText(), DuQFLog::Critical);
+    }
+
+    // This page won't have to be pulled again
+    qry.prepare( "INSERT OR REPLACE INTO _PullPages (tableName, page, pageCount, rowCount, previousSyncDate, fingerprint) "
+                 "VALUES (?, ?, ?, ?, ?, ?);" );
+    qry.addBindValue(table);
+    qry.addBindValue(page);
+    qry.addBindValue(fetchData.pageCount);
+    qry.addBindValue(fetchData.rowCount);
+    qry.addBindValue(fetchData.previousSyncDate);
+    qry.addBindValue(fetchData.fingerprint);
+    if (!qry.exec())
+        log(tr("Can't save the data from the server.") + "\n" + qry.lastError().databaseText(), DuQFLog::Critical);
+
+    if (!db.commit())
+    {
+        log(tr("Can't save the data from the server.") + "\n" + db.lastError().databaseText(), DuQFLog::Critical);
+        db.rollback();
+    }
+}
+
+void LocalDataWorker::clearStaging(const QStringList &keepTables)
+{
+    if (!m_isOpen) return;
+
+    if (keepTables.isEmpty())
+    {
+        query( "DELETE FROM _PullStaging;" );
+        query( "DELETE FROM _PullDeleted;" );
+        query( "DELETE FROM _PullPages;" );
+        return;
+    }
+
+    QStringList placeholders;
+    for (int i = 0; i < keepTables.count(); i++) placeholders << "?";
+    QString condition = " WHERE tableName NOT IN (" + placeholders.join(", ") + ");";
+
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+    const QStringList stagingTables = { "_PullStaging", "_PullDeleted", "_PullPages" };
+    for (const QString &stagingTable: stagingTables)
+    {
+        QSqlQuery qry(db);
+        qry.prepare( "DELETE FROM " + stagingTable + condition );
+        for (const QString &table: keepTables) qry.addBindValue(table);
+        if (!qry.exec())
+            log(tr("Can't clean the data from the server.") + "\n" + qry.lastError().databaseText(), DuQFLog::Warning);
+    }
+}
+
+void LocalDataWorker::vacuum()
+{
+    if (!m_isOpen)
+    {
+        emit vacuumed();
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    query( "PRAGMA auto_vacuum = INCREMENTAL;" );
+    query( "VACUUM;" );
+
+    log(tr("Database vacuumed in %1 seconds.").arg(timer.elapsed()/1000), DuQFLog::Debug);
+    emit vacuumed();
+}
+
+void LocalDataWorker::execWrite(const QString &q, const QMap<QString, QVariant> &values)
+{
+    if (!m_isOpen) return;
+
+    if (values.isEmpty())
+    {
+        query(q);
+        return;
+    }
+
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+    QSqlQuery qry = QSqlQuery(db);
+    bool ok = qry.prepare(q);
+    if (ok)
+    {
+        QMapIterator<QString, QVariant> it(values);
+        while (it.hasNext())
+        {
+            it.next();
+            qry.bindValue(it.key(), it.value());
+        }
+        ok = qry.exec();
+    }
+    if (!ok)
+    {
+        QString errorMessage = "Something went wrong when saving the data.\nHere's some information:";
+        errorMessage += "\n> " + tr("Query:") + "\n" + q;
+        errorMessage += "\n> " + tr("Database Error:") + "\n" + qry.lastError().databaseText();
+        errorMessage += "\n> " + tr("Driver Error:") + "\n" + qry.lastError().driverText();
+        log(errorMessage, DuQFLog::Critical);
+    }
+}
+
+QSqlQuery LocalDataWorker::query(const QString &q)
+{
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+    QSqlQuery qry = QSqlQuery(db);
+
+#ifdef DEBUG_DATA
+    qDebug() << "<<< SQLITE Query (worker)";
+    qDebug().noquote() << q;
+    qDebug() << ">>>";
+#endif
+
+    if (!qry.exec(q))
+    {
+        QString errorMessage = "Something went wrong when saving the data.\nHere's some information:";
+        errorMessage += "\n> " + tr("Query:") + "\n" + qry.lastQuery();
+        errorMessage += "\n> " + tr("Database Error:") + "\n" + qry.lastError().databaseText();
+        errorMessage += "\n> " + tr("Driver Error:") + "\n" + qry.lastError().driverText();
+        log(errorMessage, DuQFLog::Critical);
+    }
+
+    return qry;
+}
+
+QString LocalDataWorker::storedData(const QString &table, const TableRow &row)
+{
+    // DBInterface lives in the main thread, only use its static validation
+    QString error;
+    QString data = DBInterface::validateJsonData(row.data, &error);
+    if (data == "")
+    {
+        log(tr("Object with uuid: %1 contains invalid data.
+This data will be removed, sorry.
+"
+               "Object type: %2
+Parse error: %3
+Original data:
+%4").arg(row.uuid, table, error, row.data),
+            DuQFLog::Warning);
+        data = "{}";
+    }
+    if (table == "RamUser" && ENCRYPT_USER_DATA) data = m_crypto.clientEncrypt( data );
+    return data;
+}
+
+void LocalDataWorker::prepareIncoming()
+{
+    query( "CREATE TEMP TABLE IF NOT EXISTS _Incoming ( "
+           "\"uuid\"	TEXT NOT NULL PRIMARY KEY, "
+           "\"data\"	TEXT NOT NULL, "
+           "\"modified\"	TEXT NOT NULL, "
+           "\"removed\"	INTEGER NOT NULL, "
+           "\"userName\"	TEXT );" );
+    query( "DELETE FROM _Incoming;" );
+}
+
+QVector<TableChange> LocalDataWorker::mergeRows(const QString &table, const QSet<TableRow> &rows)
+{
+    if (!loadIncoming(table, rows)) return QVector<TableChange>();
+    return mergeIncoming(table);
+}
+
+bool LocalDataWorker::loadIncoming(const QString &table, const QSet<TableRow> &rows)
+{
+    if (rows.isEmpty()) return false;
+
+    // Load the incoming rows in a temp table, with a single batch insert
+    prepareIncoming();
+
+    QVariantList uuids, datas, modifieds, removeds, userNames;
+    for (const TableRow &incomingRow: rows)
+    {
+        if (incomingRow.uuid == "") continue;
+        uuids << incomingRow.uuid;
+        datas << storedData(table, incomingRow);
+        modifieds << incomingRow.modified;
+        removeds << incomingRow.removed;
+        userNames << incomingRow.userName;
+    }
+
+    if (uuids.isEmpty()) return false;
+
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+    QSqlQuery qry(db);
+    qry.prepare( "INSERT OR REPLACE INTO _Incoming (uuid, data, modified, removed, userName) VALUES (?, ?, ?, ?, ?);" );
+    qry.addBindValue(uuids);
+    qry.addBindValue(datas);
+    qry.addBindValue(modifieds);
+    qry.addBindValue(removeds);
+    qry.addBindValue(userNames);
+    if (!qry.execBatch())
+    {
+        log(tr("Can't load the data from the server.") + "\n" + qry.lastError().databaseText(), DuQFLog::Critical);
+        return false;
+    }
+    return true;
+}
+
+bool LocalDataWorker::loadStagedIncoming(const QString &table)
+{
+    prepareIncoming();
+
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+    QSqlQuery qry(db);
+    qry.prepare( "INSERT OR REPLACE INTO _Incoming (uuid, data, modified, removed, userName) "
+                 "SELECT uuid, data, modified, removed, userName FROM _PullStaging "
+                 "WHERE tableName = ? AND uuid != '';" );
+    qry.addBindValue(table);
+    if (!qry.exec())
+    {
+        log(tr("Can't load the data from the server.") + "\n" + qry.lastError().databaseText(), DuQFLog::Critical);
+        return false;
+    }
+    return qry.numRowsAffected() != 0;
+}
+
+QVector<TableChange> LocalDataWorker::mergeIncoming(const QString &table)
+{
+    QVector<TableChange> changes;
+
+    // Tables we don't know may come from the server
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+    TableDescriptor descriptor = LocalDataInterface::tableDescriptor(table);
+    if (descriptor.columns.isEmpty()) LocalDataInterface::createTable(db, descriptor);
+
+    bool isUserTable = table == "RamUser";
+    bool hasUserName = descriptor.hasUserName;
+    // The data must be emitted as it is used (not encrypted)
+    bool decrypt = isUserTable && ENCRYPT_USER_DATA;
+
+    // The Ramses user is never added from the server
+    QString skipRamses = isUserTable ? " AND i.userName IS NOT 'Ramses'" : "";
+
+    // New rows
+    QSqlQuery qry = query( QString("SELECT i.uuid, i.modified, i.data FROM _Incoming AS i "
+                         "LEFT JOIN \"%1\" AS t ON t.uuid = i.uuid "
+                         "WHERE t.uuid IS NULL AND i.removed = 0%2;").arg(table, skipRamses) );
+    while (qry.next())
+    {
+        TableChange c;
+        c.type = TableChange::Inserted;
+        c.uuid = qry.value(0).toString();
+        c.data = qry.value(2).toString();
+        if (decrypt) c.data = m_crypto.clientDecrypt( c.data );
+        c.modified = qry.value(1).toString();
+        c.table = table;
+        changes << c;
+    }
+
+    // New rows, already removed: only for the uuid index
+    qry = query( QString("SELECT i.uuid FROM _Incoming AS i "
+                         "LEFT JOIN \"%1\" AS t ON t.uuid = i.uuid "
+                         "WHERE t.uuid IS NULL AND i.removed = 1%2;").arg(table, skipRamses) );
+    while (qry.next())
+    {
+        TableChange c;
+        c.type = TableChange::InsertedRemoved;
+        c.uuid = qry.value(0).toString();
+        c.table = table;
+        c.available = false;
+        changes << c;
+    }
+
+    // Updated rows (dates are ISO strings, they're compared as is)
+    qry = query( QString("SELECT i.uuid, i.modified, i.removed, t.removed, i.data FROM _Incoming AS i "
+                         "JOIN \"%1\" AS t ON t.uuid = i.uuid "
+                         "WHERE i.modified > t.modified;").arg(table) );
+    while (qry.next())
+    {
+        TableChange c;
+        c.uuid = qry.value(0).toString();
+        c.table = table;
+
+        // Check if the object has been removed or restored
+        bool hasBeenRemoved = qry.value(2).toBool();
+        if (qry.value(3).toBool() != hasBeenRemoved)
+        {
+            c.type = TableChange::AvailabilityChanged;
+            c.available = !hasBeenRemoved;
+            changes << c;
+            if (hasBeenRemoved)
+            {
+                c.type = TableChange::Removed;
+                changes << c;
+            }
+        }
+
+        c.type = TableChange::DataChanged;
+        c.data = qry.value(4).toString();
+        if (decrypt) c.data = m_crypto.clientDecrypt( c.data );
+        c.modified = qry.value(1).toString();
+        changes << c;
+    }
+
+    // Apply, only the new and more recent rows
+    QString columns = "data, modified, uuid, removed";
+    QString updates = "`data` = excluded.data, `modified` = excluded.modified, `removed` = excluded.removed";
+    if (hasUserName)
+    {
+        columns += ", userName";
+        updates += ", `userName` = excluded.userName";
+    }
+    QString filter = "1";
+    if (isUserTable) filter = "i.userName IS NOT 'Ramses' OR i.uuid IN (SELECT uuid FROM \"RamUser\")";
+    // The WHERE clause is needed by SQLite to parse the upsert after a SELECT
+    QString q = "INSERT INTO \"%1\" (%2) "
+                "SELECT %2 FROM _Incoming AS i WHERE %3 "
+                "ON CONFLICT(uuid) DO UPDATE SET %4 "
+                "WHERE excluded.modified > \"%1\".modified ;";
+    query( q.arg(table, columns, filter, updates) );
+
+    query( "DELETE FROM _Incoming;" );
+
+    return changes;
+}
+
+TableChange LocalDataWorker::deletedChange(const QString &table, const QString &uuid)
+{
+    TableChange c;
+    c.type = TableChange::Deleted;
+    c.uuid = uuid;
+    c.table = table;
+    return c;
+}
+
+void LocalDataWorker::deleteRows(const QString &table, const QStringList &uuids)
+{
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+    LocalDataInterface::deleteRows(db, table, uuids);
+}
@@ -0,0 +1,92 @@
+#ifndef LOCALDATAWORKER_H
+#define LOCALDATAWORKER_H
+
+#include <QSqlQuery>
+#include <QSqlError>
+#include <QStringBuilder>
+
+#include "duqf-utils/duqflogger.h"
+#include "enums.h"
+#include "datastruct.h"
+#include "datacrypto.h"
+
+/**
+ * @brief The LocalDataWorker class runs the heavy SQLite work in its own thread.
+ * It owns its own connection to the local database file, and must only be used
+ * through queued invocations from the LocalDataInterface, which owns its thread.
+ * The changes it writes are sent back with signals, in batches (one per table).
+ */
+class LocalDataWorker : public DuQFLoggerObject
+{
+    Q_OBJECT
+public:
+    explicit LocalDataWorker(QObject *parent = nullptr);
+
+    // Opens (or re-opens) the connection to the database file
+    void openFile(const QString &file, StorageProfile profile);
+    // Closes the connection; needed before the file is moved or its journal mode changed
+    void closeFile();
+
+    /**
+     * @brief saveSync Merges the data pulled from the server, deletes the out-of-date data,
+     * and saves the sync date, in a single transaction.
+     * Emits changesSaved() for each table, then syncSaved(), with false if the data couldn't be saved.
+     */
+    void saveSync(SyncData syncData, QString serverUuid);
+
+    /**
+     * @brief stagePage Saves a page pulled from the server in the staging tables,
+     * to be merged by saveSync() when the sync data is staged.
+     * The page is recorded in _PullPages, so an interrupted sync can be resumed.
+     */
+    void stagePage(TableFetchData table, int page, QSet<TableRow> rows, QStringList deletedUuids);
+    // Empties the staging tables, except for the given tables
+    void clearStaging(const QStringList &keepTables = QStringList());
+
+    // Full vacuum, switching the file to incremental auto vacuum. Emits vacuumed() when it's done.
+    void vacuum();
+
+    /**
+     * @brief execWrite Runs a write from the main connection, held back while a sync was being saved.
+     * @param values The values to bind, by placeholder name
+     */
+    void execWrite(const QString &q, const QMap<QString, QVariant> &values);
+
+signals:
+    void progress(QString text);
+    void changesSaved(QVector<TableChange> changes);
+    void syncSaved(bool ok);
+    void vacuumed();
+
+private:
+    QSqlQuery query(const QString &q);
+
+    // The data as it is stored: validated, and encrypted for users
+    QString storedData(const QString &table, const TableRow &row);
+    // Creates or empties the _Incoming temp table
+    void prepareIncoming();
+
+    /**
+     * @brief mergeRows Merges the rows from the server in a table (loadIncoming() then mergeIncoming()).
+     * Must be called inside a transaction.
+     * @return The changes to emit once committed
+     */
+    QVector<TableChange> mergeRows(const QString &table, const QSet<TableRow> &rows);
+    bool loadIncoming(const QString &table, const QSet<TableRow> &rows);
+    bool loadStagedIncoming(const QString &table);
+    /**
+     * @brief mergeIncoming Merges the rows of the _Incoming temp table, using joins:
+     * new rows are inserted, more recent rows are updated.
+     */
+    QVector<TableChange> mergeIncoming(const QString &table);
+    void deleteRows(const QString &table, const QStringList &uuids);
+    // The change sent for the uuid index when a row is deleted
+    TableChange deletedChange(const QString &table, const QString &uuid);
+
+    QString m_connectionName = "localdataworker";
+    bool m_isOpen = false;
+    // The DataCrypto instance is used by the main thread
+    DataCrypto m_crypto;
+};
+
+#endif // LOCALDATAWORKER_H
@@ -0,0 +1,140 @@
+#include "pullreplyreader.h"
+
+PullReplyReader::PullReplyReader()
+{
+
+}
+
+void PullReplyReader::addData(const QByteArray &data)
+{
+    for (const char c: data)
+    {
+        const bool inRows = m_rowsDepth >= 0;
+
+        // In strings, just look for the end
+        if (m_inString)
+        {
+            if (inRows) m_row.append(c);
+            else m_envelope.append(c);
+
+            if (m_escaped) m_escaped = false;
+            else if (c == '\\') m_escaped = true;
+            else if (c == '"')
+            {
+                m_inString = false;
+                if (m_readingKey) m_stack.last().key = m_key;
+                m_readingKey = false;
+            }
+            else if (m_readingKey) m_key.append(c);
+            continue;
+        }
+
+        // Inside content.rows: keep the rows apart
+        if (inRows)
+        {
+            const int depth = m_stack.count();
+            if (c == '{' || c == '[')
+            {
+                // A new row
+                if (depth == m_rowsDepth) m_row.clear();
+                Container container;
+                container.type = c;
+                m_stack << container;
+                m_row.append(c);
+            }
+            else if (c == '}' || c == ']')
+            {
+                m_stack.removeLast();
+                // The end of the array
+                if (depth == m_rowsDepth)
+                {
+                    m_rowsDepth = -1;
+                    m_envelope.append(c);
+                    continue;
+                }
+                m_row.append(c);
+                // The end of a row
+                if (m_stack.count() == m_rowsDepth) readRow();
+            }
+            else if (depth > m_rowsDepth)
+            {
+                if (c == '"') m_inString = true;
+                m_row.append(c);
+            }
+            // Separators between rows are not needed
+            continue;
+        }
+
+        m_envelope.append(c);
+
+        if (c == '"')
+        {
+            m_inString = true;
+            m_readingKey = !m_stack.isEmpty() && m_stack.last().type == '{' && m_stack.last().expectKey;
+            m_key.clear();
+        }
+        else if (c == ':')
+        {
+            if (!m_stack.isEmpty()) m_stack.last().expectKey = false;
+        }
+        else if (c == ',')
+        {
+            if (!m_stack.isEmpty() && m_stack.last().type == '{') m_stack.last().expectKey = true;
+        }
+        else if (c == '{' || c == '[')
+        {
+            Container container;
+            container.type = c;
+            container.expectKey = c == '{';
+            m_stack << container;
+
+            // This is content.rows
+            if (c == '[' && m_stack.count() == 3 && m_stack.at(0).key == "content" && m_stack.at(1).key == "rows")
+                m_rowsDepth = m_stack.count();
+        }
+        else if (c == '}' || c == ']')
+        {
+            if (!m_stack.isEmpty()) m_stack.removeLast();
+        }
+    }
+}
+
+QSet<TableRow> PullReplyReader::takeRows()
+{
+    QSet<TableRow> rows = m_rows;
+    m_rows = QSet<TableRow>();
+    return rows;
+}
+
+const QByteArray &PullReplyReader::envelope() const
+{
+    return m_envelope;
+}
+
+void PullReplyReader::readRow()
+{
+    QJsonObject rowObj = QJsonDocument::fromJson(m_row).object();
+    m_row.clear();
+    if (rowObj.isEmpty()) return;
+
+    TableRow row;
+    row.uuid = rowObj.value("uuid").toString();
+    row.data = rowObj.value("data").toString();
+
+#ifdef DEBUG_DATA
+        qDebug().noquote() << "<<< Received data";
+        qDebug().noquote() <<"raw data:";
+        qDebug().noquote() << rowObj.value("data");
+        qDebug().noquote() <<"parsed data:";
+        qDebug().noquote() << row.data;
+        qDebug() << ">>>";
+#endif
+
+    row.modified = rowObj.value("modified").toString();
+    row.removed = rowObj.value("removed").toInt();
+    row.userName = rowObj.value("userName").toString();
+
+    // A row found twice: the last one wins
+    m_rows.remove(row);
+    m_rows.insert(row);
+}
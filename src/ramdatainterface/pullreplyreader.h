@@ -0,0 +1,58 @@
+#ifndef PULLREPLYREADER_H
+#define PULLREPLYREADER_H
+
+#include <QJsonObject>
+#include <QJsonDocument>
+
+#include "datastruct.h"
+
+/**
+ * @brief The PullReplyReader class parses the reply to a pull request while it's being received.
+ * Each row of "content.rows" is converted to a TableRow as soon as it's complete,
+ * and the rest of the reply (the envelope, with an empty rows array) is kept to be parsed at the end.
+ * This way, the whole page is never held as text nor as a JSON document.
+ */
+class PullReplyReader
+{
+public:
+    PullReplyReader();
+
+    /**
+     * @brief addData Reads a new chunk of the reply
+     */
+    void addData(const QByteArray &data);
+    /**
+     * @brief takeRows The rows read so far
+     */
+    QSet<TableRow> takeRows();
+    /**
+     * @brief envelope The reply without its rows
+     */
+    const QByteArray &envelope() const;
+
+private:
+    struct Container
+    {
+        char type;
+        bool expectKey = false;
+        QByteArray key;
+    };
+
+    void readRow();
+
+    QVector<Container> m_stack;
+    QByteArray m_envelope;
+    // The current row, until it's complete
+    QByteArray m_row;
+    // The current key, while it's being read
+    QByteArray m_key;
+    bool m_inString = false;
+    bool m_escaped = false;
+    bool m_readingKey = false;
+    // The depth of the rows array, -1 when not in it
+    int m_rowsDepth = -1;
+
+    QSet<TableRow> m_rows;
+};
+
+#endif // PULLREPLYREADER_H
@@ -61,6 +61,29 @@ void RamServerInterface::setTimeout(int newTimeout)
     m_timeout = newTimeout;
 }
 
+int RamServerInterface::pullWindow() const
+{
+    return m_pullWindow;
+}
+
+void RamServerInterface::setPullWindow(int newPullWindow)
+{
+    if (newPullWindow < 1) newPullWindow = 1;
+    m_pullWindow = newPullWindow;
+    QSettings settings;
+    settings.setValue("server/pullWindow", m_pullWindow);
+}
+
+bool RamServerInterface::stagePulls() const
+{
+    return m_stagePulls;
+}
+
+void RamServerInterface::setStagePulls(bool stage)
+{
+    m_stagePulls = stage;
+}
+
 int RamServerInterface::serverPort() const
 {
     return m_serverPort;
@@ -105,6 +128,16 @@ bool RamServerInterface::isSyncing() const
     return m_syncing;
 }
 
+const SyncStats &RamServerInterface::lastSyncStats() const
+{
+    return m_syncStats;
+}
+
+void RamServerInterface::setLastSyncFailed()
+{
+    m_syncStats.withError = true;
+}
+
 // API
 
 void RamServerInterface::ping()
@@ -280,13 +313,18 @@ void RamServerInterface::login()
     StateManager::i()->setState(previousState);
 }
 
-void RamServerInterface::sync(SyncData syncData)
+void RamServerInterface::sync(SyncData syncData, QStringList tables)
 {
     // We should not already be in a sync
     if (m_syncing) return;
 
     // Save sync data
     m_syncingData = syncData;
+    m_fetchTables = tables;
+
+    m_syncStats = SyncStats();
+    m_syncStats.start = QDateTime::currentDateTimeUtc();
+    for (const QSet<TableRow> &rows: qAsConst(syncData.tables)) m_syncStats.pushedRows += rows.count();
 
     // Start session
     startSync();
@@ -549,7 +587,21 @@ void RamServerInterface::sslError(QNetworkReply *reply, QList<QSslError> errs)
 
 void RamServerInterface::dataReceived(QNetworkReply *reply)
 {
-    QJsonObject repObj = parseData(reply);
+    // Change notifications are handled on their own
+    if (reply->request().attribute(WatchAttribute, false).toBool())
+    {
+        watchReceived(reply);
+        return;
+    }
+
+    // Pull replies have already been (partially) read
+    QScopedPointer<PullReplyReader> pullReader( m_pullReaders.take(reply) );
+
+    // Late pull reply from a previous sync
+    QVariant generation = reply->request().attribute(SyncGenerationAttribute);
+    if (generation.isValid() && generation.toInt() != m_syncGeneration) return;
+
+    QJsonObject repObj = parseData(reply, pullReader.data());
     if (repObj.isEmpty()) {
         finishSync(true);
         return;
@@ -612,11 +664,19 @@ void RamServerInterface::dataReceived(QNetworkReply *reply)
             return;
         }
 
+        // Binary rows
+        m_serverRowFormats.clear();
+        const QJsonArray rowFormats = content.value("rowFormats").toArray();
+        for (const QJsonValue &format: rowFormats) m_serverRowFormats << format.toString();
+
         // Start pushing
-        pushNext();
+        startPush(content.value("pushWindow").toInt(1));
     }
     else if (repQuery == "push")
     {
+        // Late reply from a sync which has already failed
+        if (!m_syncing) return;
+
         // If sync is not successful, stop syncing.
         if (!repSuccess)
         {
@@ -632,6 +692,7 @@ void RamServerInterface::dataReceived(QNetworkReply *reply)
             return;
         }
         // Continue pushing
+        m_pushesInFlight--;
         pushNext();
     }
     else if (repQuery == "fetch")
@@ -650,6 +711,7 @@ void RamServerInterface::dataReceived(QNetworkReply *reply)
         if (m_fetchData.tableCount == 0)
         {
             finishSync();
+            return;
         }
         QJsonArray fetchedTables = content.value("tables").toArray();
         ProgressManager *pm = ProgressManager::instance();
@@ -659,17 +721,40 @@ void RamServerInterface::dataReceived(QNetworkReply *reply)
             QJsonObject fetchObj = fetchedTables.at(i).toObject();
             TableFetchData fetchData;
             fetchData.name = fetchObj.value("name").toString();
+            // Only the requested tables
+            if (!m_fetchTables.isEmpty() && !m_fetchTables.contains(fetchData.name)) continue;
             fetchData.rowCount = fetchObj.value("rowCount").toInt();
             fetchData.pageCount = fetchObj.value("pageCount").toInt();
             fetchData.deleteCount = fetchObj.value("deleteCount").toInt();
+            fetchData.previousSyncDate = m_syncingData.syncDate;
+            fetchData.fingerprint = fetchObj.value("lastModified").toString();
+            if (fetchData.fingerprint == "") fetchData.fingerprint = fetchObj.value("checksum").toString();
             m_fetchData.tables.insert(fetchData);
+            m_syncStats.pulledRows += fetchData.rowCount;
+            m_syncStats.deletedRows += fetchData.deleteCount;
             pm->addToMaximum(fetchData.pageCount);
         }
-        // Start pulling
+        // Start pulling, with a new pipeline
+        m_pullData.staged = m_stagePulls;
+        m_resumedPages.clear();
+        if (m_stagePulls)
+        {
+            m_resumedPages = LocalDataInterface::instance()->resumePull(m_fetchData.tables);
+            int resumedCount = 0;
+            for (const QSet<int> &pages: qAsConst(m_resumedPages)) resumedCount += pages.count();
+            if (resumedCount > 0) log(tr("Resuming the previous sync: %1 pages have already been downloaded.").arg(resumedCount), DuQFLog::Information);
+        }
+        m_pulledPages.clear();
+        m_pullsInFlight = 0;
+        m_pullDelay = m_requestDelay;
+        m_pullBestLatency = -1;
         pullNext();
     }
     else if (repQuery == "pull")
     {
+        // Late reply from a sync which has already failed
+        if (!m_syncing) return;
+
         // If sync is not successful, stop syncing.
         if (!repSuccess)
         {
@@ -678,43 +763,17 @@ void RamServerInterface::dataReceived(QNetworkReply *reply)
             finishSync(true);
             return;
         }
-        // Store new data
-        QJsonArray rowsArray = content.value("rows").toArray();
-        QJsonArray deletedArray = content.value("deleted").toArray();
-        QString table = content.value("table").toString();
-        QSet<TableRow> rows;
-        QStringList deletedUuids;
-        if (m_pullData.tables.contains(table)) rows = m_pullData.tables.value(table);
-        for (int i = 0; i < rowsArray.count(); i++)
-        {
-            TableRow row;
-            QJsonObject rowObj = rowsArray.at(i).toObject();
-            row.uuid = rowObj.value("uuid").toString();
-            row.data = rowObj.value("data").toString();
 
-#ifdef DEBUG_DATA
-                qDebug().noquote() << "<<< Received data";
-                qDebug().noquote() <<"raw data:";
-                qDebug().noquote() << rowObj.value("data");
-                qDebug().noquote() <<"parsed data:";
-                qDebug().noquote() << row.data;
-                qDebug() << ">>>";
-#endif
-
-
-            row.modified = rowObj.value("modified").toString();
-            row.removed = rowObj.value("removed").toInt();
-            row.userName = rowObj.value("userName").toString();
-            rows.insert(row);
-        }
-        for (int i = 0; i < deletedArray.count(); i++)
+        adaptPullDelay(reply);
+        QSet<TableRow> rows;
+        if (pullReader) rows = pullReader->takeRows();
+        if (!pullReceived(reply->request().attribute(PullPageAttribute, 0).toInt(), content, rows))
         {
-            QString uuid = deletedArray.at(i).toString();
-            deletedUuids << uuid;
+            log(tr("The server sent rows which can't be read."), DuQFLog::Warning);
+            finishSync(true);
+            return;
         }
-        m_pullData.tables.insert(table, rows);
-        m_pullData.deletedUuids.insert(table, deletedUuids);
-        // Next pull
+        // Next pulls
         pullNext();
     }
     else if (repQuery == "setPassword")
@@ -879,7 +938,7 @@ void RamServerInterface::pauseQueue()
     m_requestQueueTimer->stop();
 }
 
-QJsonObject RamServerInterface::parseData(QNetworkReply *reply)
+QJsonObject RamServerInterface::parseData(QNetworkReply *reply, PullReplyReader *reader)
 {
     if (reply->error() != QNetworkReply::NoError)
     {
@@ -890,12 +949,25 @@ QJsonObject RamServerInterface::parseData(QNetworkReply *reply)
         repObj.insert("success",false);
     }
 
-    QString repAll = QString::fromUtf8(reply->readAll());
+    // Check if we can compress the next requests
+    m_deflateRequests = reply->rawHeader("Accept-Encoding").toLower().contains("deflate");
 
+    // Check if the server is asking to slow down
+    bool retryOk = false;
+    int retryAfter = reply->rawHeader("Retry-After").toInt(&retryOk);
+    if (retryOk && m_syncing) m_syncStats.retryAfter = qMax(m_syncStats.retryAfter, retryAfter * 1000);
 
+    // The rows of a pull reply have been read by the reader
+    QByteArray repData;
+    if (reader)
+    {
+        reader->addData(reply->readAll());
+        repData = reader->envelope();
+    }
+    else repData = reply->readAll();
 
     reply->deleteLater();
-    QJsonDocument repDoc = QJsonDocument::fromJson(repAll.toUtf8());
+    QJsonDocument repDoc = QJsonDocument::fromJson(repData);
     QJsonObject repObj = repDoc.object();
 
     if (repObj.isEmpty())
@@ -912,7 +984,7 @@ QJsonObject RamServerInterface::parseData(QNetworkReply *reply)
     QString repQuery = repObj.value("query").toString();
     QString repMessage = repObj.value("message").toString();
 
-    log(repQuery + "\n" + repMessage + "\nContent:\n" + repAll, DuQFLog::Data);
+    log(repQuery + "\n" + repMessage + "\nContent:\n" + QString::fromUtf8(repData), DuQFLog::Data);
 
     if (repObj.value("error").toBool(false)) return QJsonObject();
 
@@ -982,6 +1054,13 @@ RamServerInterface::RamServerInterface():
 
     // Don't post too many request at the same time
     m_requestQueueTimer = new QTimer(this);
+    m_pullTimer = new QTimer(this);
+    m_pullTimer->setSingleShot(true);
+    m_watchTimer = new QTimer(this);
+    m_watchTimer->setSingleShot(true);
+
+    QSettings settings;
+    m_pullWindow = qMax(1, settings.value("server/pullWindow", m_pullWindow).toInt());
 
     connectEvents();
 }
@@ -989,6 +1068,8 @@ RamServerInterface::RamServerInterface():
 void RamServerInterface::connectEvents()
 {
     connect(m_requestQueueTimer, &QTimer::timeout, this, &RamServerInterface::nextRequest);
+    connect(m_pullTimer, &QTimer::timeout, this, &RamServerInterface::pullNext);
+    connect(m_watchTimer, &QTimer::timeout, this, &RamServerInterface::watch);
     connect(m_network, &QNetworkAccessManager::finished, this, &RamServerInterface::dataReceived);
     connect(m_network, &QNetworkAccessManager::sslErrors, this, &RamServerInterface::sslError);
     connect(qApp, &QApplication::aboutToQuit, this, &RamServerInterface::flushRequests);
@@ -1044,8 +1125,12 @@ void RamServerInterface::startSync()
 
     queueRequest("sync");
     m_syncing = true;
+    m_syncGeneration++;
     m_pullData.syncDate = QDateTime::currentDateTimeUtc().toString("yyyy-MM-dd hh:mm:ss");
+    // The sync date can be saved only if all tables are fetched
+    if (!m_fetchTables.isEmpty()) m_pullData.syncDate = "";
     m_pullData.tables = QHash<QString, QSet<TableRow>>();
+    m_pullData.changeId = m_syncingData.changeId;
     emit syncStarted();
 }
 
@@ -1072,47 +1157,124 @@ void RamServerInterface::push(QString table, QSet<TableRow> rows, QString date,
     queueRequest("push", body);
 }
 
+void RamServerInterface::startPush(int window)
+{
+    m_pushWindow = qBound(1, window, 8);
+    m_pushesInFlight = 0;
+    m_pushTables = m_syncingData.tables.keys();
+    m_pushTable = "";
+    m_pushRows.clear();
+    m_pushRowIndex = 0;
+    m_pushReadyQueue.clear();
+
+    pushNext();
+}
+
 void RamServerInterface::pushNext()
 {
-    // If the tables list is empty, we've pushed everything, commit
-    if (m_syncingData.tables.isEmpty())
+    if (!m_syncing) return;
+
+    // Keep the ready queue full
+    while (m_pushReadyQueue.count() < m_pushWindow)
     {
-        commit();
-        return;
+        if (!preparePushBatch()) break;
+    }
+
+    // Post while the server accepts more
+    while (m_pushesInFlight < m_pushWindow && !m_pushReadyQueue.isEmpty())
+    {
+        m_pushesInFlight++;
+        postRequest( m_pushReadyQueue.takeFirst() );
+    }
+
+    // Commit only when all the batches have been received
+    if (m_pushesInFlight == 0 && m_pushReadyQueue.isEmpty()) commit();
+}
+
+bool RamServerInterface::preparePushBatch()
+{
+    // Get the rows of the next table
+    while (m_pushRowIndex >= m_pushRows.count())
+    {
+        if (m_pushTable != "")
+        {
+            ProgressManager *pm = ProgressManager::instance();
+            pm->increment();
+            pm->setText(tr("Uploading data to the server..."));
+            m_pushTable = "";
+        }
+        if (m_pushTables.isEmpty()) return false;
+
+        m_pushTable = m_pushTables.takeFirst();
+        m_pushRows = m_syncingData.tables.take(m_pushTable).values().toVector();
+        m_pushRowIndex = 0;
     }
 
-    // Get a table and push its first 100 rows
-    QString table = *m_syncingData.tables.keyBegin();
-    QSet<TableRow> rows = m_syncingData.tables.value(table);
-    QSet<TableRow> pushRows;
-    while (pushRows.count() < m_requestMaxRows && !rows.isEmpty())
+    bool isUserTable = m_pushTable == "RamUser";
+    bool binary = m_serverRowFormats.contains(TableRowCodec::formatName());
+
+    // Serialize rows until the batch is big enough
+    QJsonArray rowsArray;
+    QVector<TableRow> binaryRows;
+    int rowCount = 0;
+    int batchSize = 0;
+    while (m_pushRowIndex < m_pushRows.count() && rowCount < m_requestMaxRows && batchSize < m_pushMaxBytes)
     {
-        QSet<TableRow>::const_iterator i = rows.cbegin();
-        pushRows.insert( *i );
+        const TableRow &row = m_pushRows.at(m_pushRowIndex);
 
 #ifdef DEBUG_DATA
             qDebug().noquote() << "<<< SENT DATA";
-            qDebug().noquote() << (*i).data;
+            qDebug().noquote() << row.data;
             qDebug() << ">>>";
 #endif
 
-        rows.erase( i );
+        rowCount++;
+        if (binary)
+        {
+            binaryRows << row;
+            // The user name is only sent for users
+            if (!isUserTable) binaryRows.last().userName = "";
+        }
+        else
+        {
+            QJsonObject rowObj;
+            rowObj.insert("uuid", row.uuid);
+            rowObj.insert("data", row.data);
+            rowObj.insert("removed", row.removed);
+            rowObj.insert("modified", row.modified);
+            if (isUserTable) rowObj.insert("userName", row.userName);
+            rowsArray.append(rowObj);
+        }
+
+        // The data is a JSON string in a JSON string: count the escaped characters too
+        batchSize += row.uuid.size() + row.modified.size() + row.userName.size() + 64 +
+                row.data.size() + row.data.count('"') + row.data.count('\\');
+
+        m_pushRowIndex++;
+    }
+
+    // Free the rows of the table as soon as they're all serialized
+    if (m_pushRowIndex >= m_pushRows.count())
+    {
+        m_pushRows.clear();
+        m_pushRowIndex = 0;
     }
 
-    // Update rows in syncing data
-    m_syncingData.tables[table] = rows;
+    qDebug() << "Server Interface: Ready to push " << rowCount << " rows (" << batchSize << " bytes) to " << m_pushTable;
 
-    // If we've got all rows, remove the table from the data to sync
-    if (rows.isEmpty())
+    QJsonObject body;
+    body.insert("table", m_pushTable);
+    if (binary)
     {
-        ProgressManager *pm = ProgressManager::instance();
-        pm->increment();
-        pm->setText(tr("Uploading data to the server..."));
-        m_syncingData.tables.remove(table);
+        body.insert("rowFormat", TableRowCodec::formatName());
+        body.insert("rows", QString::fromLatin1(TableRowCodec::encode(binaryRows).toBase64()));
     }
+    else body.insert("rows", rowsArray);
+    body.insert("previousSyncDate", m_syncingData.syncDate);
+    body.insert("commit", false);
+    m_pushReadyQueue << buildRequest("push", body);
 
-    // Push the rows
-    push(table, pushRows, m_syncingData.syncDate, false);
+    return true;
 }
 
 void RamServerInterface::commit()
@@ -1126,7 +1288,95 @@ void RamServerInterface::fetch()
 {
     qDebug() << "Server Interface: Fetching changes...";
 
-    queueRequest("fetch");
+    QJsonObject body;
+    if (!m_fetchTables.isEmpty()) body.insert("tables", QJsonArray::fromStringList(m_fetchTables));
+    queueRequest("fetch", body);
+}
+
+void RamServerInterface::startWatching()
+{
+    if (m_watching) return;
+    m_watching = true;
+    m_watchSequence = -1;
+    m_watchRetryDelay = 5000;
+    m_watchHttpErrors = 0;
+    watch();
+}
+
+void RamServerInterface::stopWatching()
+{
+    m_watching = false;
+    m_watchTimer->stop();
+    if (m_watchReply) m_watchReply->abort();
+}
+
+void RamServerInterface::watch()
+{
+    if (!m_watching || m_watchReply) return;
+    if (m_status != NetworkUtils::Online) return;
+
+    QJsonObject body;
+    body.insert("sequence", m_watchSequence);
+    Request r = buildRequest("watch", body);
+    r.request.setAttribute(WatchAttribute, true);
+
+    // Not posted with postRequest(): a long-poll failing must not set us offline
+    QByteArray data = requestBody(r);
+    m_watchReply = m_network->post(r.request, data);
+}
+
+void RamServerInterface::watchReceived(QNetworkReply *reply)
+{
+    reply->deleteLater();
+    if (reply == m_watchReply) m_watchReply = nullptr;
+    if (!m_watching) return;
+
+    // Try again later
+    if (reply->error() != QNetworkReply::NoError)
+    {
+        log(tr("Change notifications interrupted: %1").arg(reply->errorString()), DuQFLog::Debug);
+
+        // Not a network error: retrying won't help for long
+        int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        if (status >= 400 && reply->error() != QNetworkReply::OperationCanceledError) m_watchHttpErrors++;
+        if (m_watchHttpErrors >= 3)
+        {
+            log(tr("The server refuses to send change notifications (HTTP %1), the data will be synced at regular intervals.").arg(status), DuQFLog::Information);
+            m_watching = false;
+            return;
+        }
+
+        m_watchTimer->start(m_watchRetryDelay);
+        m_watchRetryDelay = qMin(m_watchRetryDelay * 2, 300000);
+        return;
+    }
+
+    QJsonObject repObj = QJsonDocument::fromJson(reply->readAll()).object();
+    if (repObj.value("query").toString() != "watch" || !repObj.value("success").toBool())
+    {
+        log(tr("The server does not send change notifications, the data will be synced at regular intervals."), DuQFLog::Information);
+        m_watching = false;
+        return;
+    }
+    m_watchRetryDelay = 5000;
+    m_watchHttpErrors = 0;
+
+    QJsonObject content = repObj.value("content").toObject();
+    qint64 sequence = content.value("sequence").toVariant().toLongLong();
+    QStringList tables;
+    const QJsonArray tablesArray = content.value("tables").toArray();
+    for (const QJsonValue &table: tablesArray) tables << table.toString();
+
+    // The first reply just gives the current sequence
+    bool first = m_watchSequence < 0;
+    if (sequence > m_watchSequence)
+    {
+        m_watchSequence = sequence;
+        if (!first && !tables.isEmpty()) emit remoteChanged(tables);
+    }
+
+    // Wait for the next changes
+    watch();
 }
 
 void RamServerInterface::pull(QString table, int page)
@@ -1136,19 +1386,60 @@ void RamServerInterface::pull(QString table, int page)
     QJsonObject body;
     body.insert("table", table);
     body.insert("page", page);
-    queueRequest("pull", body);
+    // The server may send the rows in a binary format
+    body.insert("rowFormats", QJsonArray({ TableRowCodec::formatName() }));
+    Request r = buildRequest("pull", body);
+
+    // Pulls don't wait in the queue, their pace is set by the pull window and delay
+    r.request.setAttribute(PullPageAttribute, page);
+    r.request.setAttribute(PullSentAttribute, QDateTime::currentMSecsSinceEpoch());
+    r.request.setAttribute(SyncGenerationAttribute, m_syncGeneration);
+    m_pullsInFlight++;
+    QNetworkReply *reply = postRequest(r);
+    if (!reply)
+    {
+        m_pullsInFlight--;
+        return;
+    }
+
+    // Read the rows as soon as they arrive
+    m_pullReaders.insert(reply, new PullReplyReader());
+    connect(reply, &QNetworkReply::readyRead, this, [this, reply] () {
+        PullReplyReader *reader = m_pullReaders.value(reply, nullptr);
+        if (reader) reader->addData(reply->readAll());
+    });
 }
 
 void RamServerInterface::pullNext()
 {
-    if (m_fetchData.tables.isEmpty())
+    if (!m_syncing) return;
+
+    // Fill the window, unless we have to wait before the next request
+    if (!m_pullTimer->isActive())
     {
-        finishSync();
-        return;
+        while (m_pullsInFlight < m_pullWindow && m_status == NetworkUtils::Online)
+        {
+            if (!pullNextPage()) break;
+            // The timer will call us back for the next page
+            if (m_pullDelay > 0)
+            {
+                m_pullTimer->start(m_pullDelay);
+                break;
+            }
+        }
     }
 
-    // Get a table and pull its next page
-    bool finished = true;
+    // Wait for the replies
+    if (m_pullsInFlight > 0) return;
+
+    // Everything has been pulled
+    if (allPagesRequested()) finishSync();
+    // We can't pull anymore
+    else if (m_status != NetworkUtils::Online) finishSync(true);
+}
+
+bool RamServerInterface::pullNextPage()
+{
     QSet<TableFetchData>::const_iterator i = m_fetchData.tables.constBegin();
     while(i != m_fetchData.tables.constEnd())
     {
@@ -1161,21 +1452,145 @@ void RamServerInterface::pullNext()
         }
 
         ProgressManager *pm = ProgressManager::instance();
-        pm->increment();
         pm->setText(tr("Downloading new data from the server..."));
 
-        finished = false;
-        fetchData.currentPage++;
-        pull( fetchData.name, fetchData.currentPage );
+        // Skip the pages staged by the previous sync
+        const QSet<int> resumedPages = m_resumedPages.value(fetchData.name);
+        while (fetchData.currentPage < fetchData.pageCount && resumedPages.contains(fetchData.currentPage + 1))
+        {
+            fetchData.currentPage++;
+            pm->increment();
+        }
+        if (!resumedPages.isEmpty() && !m_pullData.tables.contains(fetchData.name))
+            m_pullData.tables.insert(fetchData.name, QSet<TableRow>());
+
+        bool requested = false;
+        if (fetchData.currentPage < fetchData.pageCount)
+        {
+            pm->increment();
+            fetchData.currentPage++;
+            pull( fetchData.name, fetchData.currentPage );
+            requested = true;
+        }
         if (fetchData.currentPage >= fetchData.pageCount ) fetchData.pulled = true;
 
         m_fetchData.tables.erase(i);
         m_fetchData.tables.insert(fetchData);
-        break;
+
+        // All the remaining pages of this table were staged, try the next one
+        if (!requested) return pullNextPage();
+        return true;
     }
+    return false;
+}
 
-    // Everything has been pulled
-    if (finished) finishSync();
+bool RamServerInterface::allPagesRequested() const
+{
+    for (const TableFetchData &fetchData: m_fetchData.tables)
+    {
+        if (!fetchData.pulled && fetchData.currentPage < fetchData.pageCount) return false;
+    }
+    return true;
+}
+
+bool RamServerInterface::pullReceived(int page, QJsonObject content, QSet<TableRow> rows)
+{
+    m_pullsInFlight--;
+
+    QJsonArray deletedArray = content.value("deleted").toArray();
+    QString table = content.value("table").toString();
+
+    // Binary rows
+    if (content.value("rowFormat").toString() == TableRowCodec::formatName())
+    {
+        bool ok = false;
+        const QVector<TableRow> decodedRows = TableRowCodec::decode(
+                    QByteArray::fromBase64(content.value("rows").toString().toLatin1()),
+                    &ok);
+        if (!ok) return false;
+        for (const TableRow &row: decodedRows)
+        {
+            rows.remove(row);
+            rows.insert(row);
+        }
+    }
+
+    // Send the page to be saved right away, the order is handled by the storage
+    if (m_stagePulls)
+    {
+        QStringList deletedUuids;
+        for (int i = 0; i < deletedArray.count(); i++) deletedUuids << deletedArray.at(i).toString();
+        // Keep the table name, the caches of the table are reset when the sync is saved
+        if (!m_pullData.tables.contains(table)) m_pullData.tables.insert(table, QSet<TableRow>());
+        TableFetchData fetchData;
+        fetchData.name = table;
+        QSet<TableFetchData>::const_iterator it = m_fetchData.tables.constFind(fetchData);
+        if (it != m_fetchData.tables.constEnd()) fetchData = *it;
+        emit pageReceived(fetchData, page, rows, deletedUuids);
+        return true;
+    }
+
+    QMap<int, PulledPage> &pages = m_pulledPages[table];
+    // Just in case the page was not set on the request
+    if (page <= 0) page = pages.count() + 1;
+
+    PulledPage pulledPage;
+    pulledPage.rows = rows;
+    for (int i = 0; i < deletedArray.count(); i++)
+    {
+        pulledPage.deletedUuids << deletedArray.at(i).toString();
+    }
+    pages.insert(page, pulledPage);
+
+    // Wait for the other pages of the table
+    TableFetchData key;
+    key.name = table;
+    QSet<TableFetchData>::const_iterator it = m_fetchData.tables.constFind(key);
+    if (it != m_fetchData.tables.constEnd() && pages.count() < it->pageCount) return true;
+
+    // Reassemble the table, in page order: a row found in a later page replaces the previous one
+    QSet<TableRow> tableRows = m_pullData.tables.value(table);
+    QStringList deletedUuids = m_pullData.deletedUuids.value(table);
+    for (const PulledPage &p: qAsConst(pages))
+    {
+        for (const TableRow &row: p.rows)
+        {
+            tableRows.remove(row);
+            tableRows.insert(row);
+        }
+        deletedUuids << p.deletedUuids;
+    }
+    deletedUuids.removeDuplicates();
+
+    m_pullData.tables.insert(table, tableRows);
+    m_pullData.deletedUuids.insert(table, deletedUuids);
+    m_pulledPages.remove(table);
+    return true;
+}
+
+void RamServerInterface::adaptPullDelay(QNetworkReply *reply)
+{
+    // The server tells us when to come back
+    bool ok = false;
+    int retryAfter = reply->rawHeader("Retry-After").toInt(&ok);
+    if (ok && retryAfter >= 0)
+    {
+        m_pullDelay = qMin(retryAfter * 1000, m_requestDelay * 40);
+        log(tr("The server asked to wait %1 ms between requests.").arg(m_pullDelay), DuQFLog::Debug);
+        return;
+    }
+
+    qint64 sent = reply->request().attribute(PullSentAttribute, 0).toLongLong();
+    if (sent <= 0) return;
+
+    qint64 latency = QDateTime::currentMSecsSinceEpoch() - sent;
+    if (m_pullBestLatency < 0 || latency < m_pullBestLatency) m_pullBestLatency = latency;
+
+    // The replies may wait for the other requests of the window on the server,
+    // it's only slowing down if it's worse than that
+    qint64 expectedLatency = m_pullBestLatency * qMax(2, m_pullWindow) + 100;
+    if (latency > expectedLatency) m_pullDelay = qMin( qMax(m_pullDelay * 2, 50), m_requestDelay * 8 );
+    else m_pullDelay /= 2;
 }
 
 void RamServerInterface::finishSync(bool withError)
@@ -1192,11 +1607,26 @@ void RamServerInterface::finishSync(bool withError)
     if (!withError) emit syncReady(m_pullData, m_serverUuid );
 
     // Finish
+    if (m_syncing)
+    {
+        m_syncStats.duration = m_syncStats.start.msecsTo(QDateTime::currentDateTimeUtc());
+        m_syncStats.withError = withError;
+    }
     m_syncing = false;
+    m_pullTimer->stop();
+    m_pullsInFlight = 0;
+    m_pushesInFlight = 0;
     // Make room
     m_syncingData = SyncData();
     m_fetchData = FetchData();
     m_pullData = SyncData();
+    m_pulledPages.clear();
+    m_resumedPages.clear();
+    m_pushTables.clear();
+    m_pushRows.clear();
+    m_pushReadyQueue.clear();
+    m_serverRowFormats.clear();
+    m_fetchTables.clear();
 
     emit syncFinished();
 
@@ -1204,13 +1634,15 @@ void RamServerInterface::finishSync(bool withError)
     else qDebug() << "Server Interface: Sync error!";
 }
 
-void RamServerInterface::postRequest(Request r)
+QNetworkReply *RamServerInterface::postRequest(Request r)
 {
     QUrl url = r.request.url();
     QString test = url.host();
-    if (!checkServer(test)) return;
+    if (!checkServer(test)) return nullptr;
 
-    QNetworkReply *reply = m_network->post(r.request, r.body.toUtf8());
+    // Encode first, it may set the Content-Encoding header
+    QByteArray body = requestBody(r);
+    QNetworkReply *reply = m_network->post(r.request, body);
 
     // Log URL / GET
     log( "New request: " +  url.toString(QUrl::RemovePassword), DuQFLog::Debug);
@@ -1221,6 +1653,23 @@ void RamServerInterface::postRequest(Request r)
 
     connect(reply, SIGNAL(error(QNetworkReply::NetworkError)), this,SLOT(networkError(QNetworkReply::NetworkError)));
     connect(reply, SIGNAL(finished()), reply, SLOT(deleteLater()));
+
+    return reply;
+}
+
+QByteArray RamServerInterface::requestBody(Request &r)
+{
+    QByteArray body = r.body.toUtf8();
+    if (!m_deflateRequests || body.size() < m_compressionThreshold) return body;
+
+    // qCompress returns a zlib stream (which is the HTTP "deflate" encoding)
+    // preceded by the uncompressed size on 4 bytes
+    QByteArray compressed = qCompress(body).mid(4);
+    r.request.setRawHeader("Content-Encoding", "deflate");
+
+    log( QString("Request body compressed from %1 to %2 bytes.").arg(body.size()).arg(compressed.size()), DuQFLog::Debug);
+
+    return compressed;
 }
 
 QNetworkReply *RamServerInterface::synchronousRequest(Request r)
@@ -6,6 +6,8 @@
 #include "duqf-utils/duqflogger.h"
 #include "duqf-utils/utils.h"
 #include "datastruct.h"
+#include "pullreplyreader.h"
+#include "tablerowcodec.h"
 
 class RamServerInterface : public DuQFLoggerObject
 {
@@ -33,6 +35,20 @@ public:
     void setSsl(bool useSsl);
     int timeOut() const;
     void setTimeout(int newTimeout);
+    /**
+     * @brief pullWindow The maximum number of pull requests waiting for a reply at the same time, during a sync.
+     * Saved in the settings as "server/pullWindow".
+     */
+    int pullWindow() const;
+    void setPullWindow(int newPullWindow);
+    /**
+     * @brief stagePulls When true (the default), the pulled pages are emitted with pageReceived() as soon as they arrive
+     * and the data emitted by syncReady() is marked as staged, instead of containing all the rows.
+     * This bounds the memory used by a sync to a few pages,
+     * and makes it possible to resume an interrupted sync without pulling the staged pages again.
+     */
+    bool stagePulls() const;
+    void setStagePulls(bool stage);
 
     // Status
 
@@ -46,6 +62,10 @@ public:
     bool isOnline() const;
 
     bool isSyncing() const;
+    // Statistics about the last sync (or the current one)
+    const SyncStats &lastSyncStats() const;
+    // When the pulled data of the last sync couldn't be saved locally
+    void setLastSyncFailed();
 
     // API
     /**
@@ -53,7 +73,12 @@ public:
      * @param wait when true, waits for the pong
      */
     void ping();
-    void sync(SyncData syncData);
+    /**
+     * @brief sync Starts a sync session: pushes the data, then pulls the changes
+     * @param tables When not empty, only these tables are fetched.
+     * The sync date is then not updated, the other tables will be fetched by the next complete sync.
+     */
+    void sync(SyncData syncData, QStringList tables = QStringList());
     void downloadData();
 
     const QString &currentUserUuid() const;
@@ -72,13 +97,23 @@ public slots:
     void login();
     QString doLogin(QString username, QString password, bool saveUsername = false, bool savePassword = false);
     void eraseUserPassword();
+    /**
+     * @brief startWatching Starts listening to the change notifications of the server, with a long-poll "watch" request.
+     * If the server doesn't support it, only the auto sync (polling) is used.
+     */
+    void startWatching();
+    void stopWatching();
 
 signals:
     void sslChanged(bool);
     void connectionStatusChanged(NetworkUtils::NetworkStatus, QString);
     void syncReady(SyncData data, QString serverUuid);
+    // With staged pulls, the pages are sent as soon as they're received, to be saved
+    void pageReceived(TableFetchData table, int page, QSet<TableRow> rows, QStringList deletedUuids);
     void userChanged(QString uuid, QString username, QString userdata, QString modified);
     void pong(QString serverUuid);
+    // The server has notified changes in these tables
+    void remoteChanged(QStringList tables);
     void syncStarted();
     void syncFinished();
 
@@ -149,19 +184,65 @@ private:
     // Starts a sync session
     void startSync();
     void push(QString table, QSet<TableRow> rows = QSet<TableRow>(), QString date = "1818-05-05 00:00:00", bool commit = false);
+    /**
+     * @brief startPush Prepares the push pipeline, with the number of batches the server accepts at the same time
+     */
+    void startPush(int window);
+    /**
+     * @brief pushNext Posts the ready batches while there's room in the push window,
+     * and commits once all the batches have been acknowledged.
+     */
     void pushNext();
+    /**
+     * @brief preparePushBatch Serializes the next batch of rows, up to m_pushMaxBytes, in the ready queue
+     * @return false if there are no rows left to push
+     */
+    bool preparePushBatch();
     void commit();
     void fetch();
+    /**
+     * @brief watch Posts the next long-poll request, which returns when there are new changes on the server
+     */
+    void watch();
+    void watchReceived(QNetworkReply *reply);
     void pull(QString table, int page = 1);
+    /**
+     * @brief pullNext Requests the next pages, as long as there's room in the pull window
+     * and the pull delay has elapsed. Finishes the sync when all pages have been received.
+     */
     void pullNext();
+    /**
+     * @brief pullNextPage Requests the next page of the first table which has not been completely pulled
+     * @return false if there's nothing left to request
+     */
+    bool pullNextPage();
+    bool allPagesRequested() const;
+    /**
+     * @brief pullReceived Stores a pulled page until all the pages of its table are there,
+     * then adds the rows of the table to the pulled data, in page order.
+     * @param rows The rows read by the PullReplyReader of the reply
+     * @return false if the rows sent in the binary format can't be decoded
+     */
+    bool pullReceived(int page, QJsonObject content, QSet<TableRow> rows);
+    /**
+     * @brief adaptPullDelay Adapts the delay between pull requests
+     * to the Retry-After header of the reply, or to the observed latency.
+     */
+    void adaptPullDelay(QNetworkReply *reply);
     void finishSync(bool withError = false);
 
     /**
      * @brief Posts a request to the server
      * @param request
+     * @return The reply, or nullptr if the server is not available
      */
-    void postRequest(Request r);
+    QNetworkReply *postRequest(Request r);
     QNetworkReply *synchronousRequest(Request r);
+    /**
+     * @brief requestBody Encodes the body of the request, compressing it if the server accepts it
+     * (the Content-Encoding header is set on the request)
+     */
+    QByteArray requestBody(Request &r);
     /**
      * @brief Adds a request to the queue
      * @param r the request to add
@@ -188,9 +269,10 @@ private:
     /**
      * @brief parseData Checks for errors and parses the data received from the Ramses Server
      * @param reply
+     * @param reader If the reply has been read while it was received, only the envelope is parsed
      * @return
      */
-    QJsonObject parseData(QNetworkReply *reply);
+    QJsonObject parseData(QNetworkReply *reply, PullReplyReader *reader = nullptr);
 
     // ATTRIBUTES //
 
@@ -249,6 +331,7 @@ private:
 
     SyncData m_syncingData;
     bool m_syncing = false;
+    SyncStats m_syncStats;
     FetchData m_fetchData;
     SyncData m_pullData;
 
@@ -269,6 +352,76 @@ private:
     // Requests size
     int m_requestMaxRows = 1000;
 
+    // Compression //
+
+    /**
+     * @brief m_deflateRequests True when the server accepts deflated request bodies,
+     * i.e. when its replies list "deflate" in their Accept-Encoding header (RFC 7694).
+     * The replies are decompressed by Qt, which sends its own Accept-Encoding header.
+     */
+    bool m_deflateRequests = false;
+    // Smaller bodies are not worth compressing
+    int m_compressionThreshold = 1024;
+
+    // Pipelined push //
+
+    // The maximum (approximate) size of a push batch, in bytes
+    int m_pushMaxBytes = 2 * 1024 * 1024;
+    // The number of batches the server accepts at the same time (given in the sync reply)
+    int m_pushWindow = 1;
+    int m_pushesInFlight = 0;
+    // The tables left to push, and the rows of the current table
+    QStringList m_pushTables;
+    QString m_pushTable;
+    QVector<TableRow> m_pushRows;
+    int m_pushRowIndex = 0;
+    // Batches serialized ahead of time
+    QVector<Request> m_pushReadyQueue;
+    // The row formats the server accepts besides JSON (given in the sync reply)
+    QStringList m_serverRowFormats;
+
+    // Pipelined pull //
+
+    // Attributes set on the pull requests, to find them back in the replies
+    static const QNetworkRequest::Attribute PullPageAttribute = QNetworkRequest::User;
+    static const QNetworkRequest::Attribute PullSentAttribute = static_cast<QNetworkRequest::Attribute>(QNetworkRequest::User + 1);
+    // The sync which sent the pull request; the replies of a previous sync are dropped
+    static const QNetworkRequest::Attribute SyncGenerationAttribute = static_cast<QNetworkRequest::Attribute>(QNetworkRequest::User + 3);
+    int m_syncGeneration = 0;
+
+    int m_pullWindow = 4;
+    int m_pullsInFlight = 0;
+    /**
+     * @brief m_pullDelay The delay between two pull requests.
+     * Starts at m_requestDelay, decreases while the server replies quickly,
+     * increases when it slows down or asks us to wait.
+     */
+    int m_pullDelay = 250;
+    qint64 m_pullBestLatency = -1;
+    QTimer *m_pullTimer;
+    // The pull replies are parsed while they're received
+    QHash<QNetworkReply*, PullReplyReader*> m_pullReaders;
+    // The pages received, by table and page number, until all the pages of the table are there
+    QHash<QString, QMap<int, PulledPage>> m_pulledPages;
+    bool m_stagePulls = true;
+    // When not empty, only these tables are fetched
+    QStringList m_fetchTables;
+    // The pages staged by an interrupted sync, which don't have to be pulled again
+    QHash<QString, QSet<int>> m_resumedPages;
+
+    // Change notifications //
+
+    static const QNetworkRequest::Attribute WatchAttribute = static_cast<QNetworkRequest::Attribute>(QNetworkRequest::User + 2);
+    bool m_watching = false;
+    // The last sequence number sent by the server, -1 before the first reply
+    qint64 m_watchSequence = -1;
+    QNetworkReply *m_watchReply = nullptr;
+    // To retry after a network error
+    QTimer *m_watchTimer;
+    int m_watchRetryDelay = 5000;
+    // The consecutive HTTP errors: the server is there, but it refuses to watch
+    int m_watchHttpErrors = 0;
+
     // Authentication //
     QString m_currentUserUuid;
 };
@@ -0,0 +1,203 @@
+#include "tablerowcodec.h"
+
+#include <QDataStream>
+#include <QDateTime>
+#include <QUuid>
+
+namespace TableRowCodec
+{
+
+// "RRB1"
+static const quint32 MAGIC = 0x52524231;
+
+// Flags
+static const quint8 BINARY_UUIDS = 0x01;
+static const quint8 EPOCH_DATES = 0x02;
+static const quint8 SHORT_DICTIONARY = 0x04;
+
+static const QString DATE_FORMAT = "yyyy-MM-dd hh:mm:ss";
+
+const char *formatName()
+{
+    return "rrb1";
+}
+
+QByteArray encode(const QVector<TableRow> &rows)
+{
+    // Check if uuids and dates can be stored as binary without loss
+    quint8 flags = BINARY_UUIDS | EPOCH_DATES;
+    QVector<QUuid> uuids;
+    QVector<qint64> dates;
+    uuids.reserve(rows.count());
+    dates.reserve(rows.count());
+
+    // The dictionary of user names
+    QHash<QString, quint32> dictionary;
+    QStringList dictionaryStrings;
+    QVector<quint32> userNames;
+    userNames.reserve(rows.count());
+
+    for (const TableRow &row: rows)
+    {
+        if (flags & BINARY_UUIDS)
+        {
+            QUuid uuid(row.uuid);
+            if (uuid.isNull() || uuid.toString(QUuid::WithoutBraces) != row.uuid) flags &= ~BINARY_UUIDS;
+            else uuids << uuid;
+        }
+        if (flags & EPOCH_DATES)
+        {
+            // Dates are UTC, don't let the local time zone interpret them
+            QDateTime date(QDate::fromString(row.modified.left(10), "yyyy-MM-dd"),
+                           QTime::fromString(row.modified.mid(11), "hh:mm:ss"),
+                           Qt::UTC);
+            if (!date.isValid() || date.toString(DATE_FORMAT) != row.modified) flags &= ~EPOCH_DATES;
+            else dates << date.toSecsSinceEpoch();
+        }
+
+        quint32 index = dictionary.value(row.userName, dictionaryStrings.count());
+        if (index == quint32(dictionaryStrings.count()))
+        {
+            dictionary.insert(row.userName, index);
+            dictionaryStrings << row.userName;
+        }
+        userNames << index;
+    }
+    if (dictionaryStrings.count() <= 0xFFFF) flags |= SHORT_DICTIONARY;
+
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    stream << MAGIC << quint32(rows.count()) << flags;
+
+    // uuids
+    if (flags & BINARY_UUIDS)
+    {
+        for (const QUuid &uuid: qAsConst(uuids))
+        {
+            QByteArray bytes = uuid.toRfc4122();
+            stream.writeRawData(bytes.constData(), bytes.size());
+        }
+    }
+    else for (const TableRow &row: rows) stream << row.uuid.toUtf8();
+
+    // dates
+    if (flags & EPOCH_DATES) for (qint64 date: qAsConst(dates)) stream << date;
+    else for (const TableRow &row: rows) stream << row.modified.toUtf8();
+
+    // removed
+    for (const TableRow &row: rows) stream << quint8(row.removed);
+
+    // user names
+    stream << quint32(dictionaryStrings.count());
+    for (const QString &userName: qAsConst(dictionaryStrings)) stream << userName.toUtf8();
+    if (flags & SHORT_DICTIONARY) for (quint32 index: qAsConst(userNames)) stream << quint16(index);
+    else for (quint32 index: qAsConst(userNames)) stream << index;
+
+    // data
+    for (const TableRow &row: rows) stream << row.data.toUtf8();
+
+    return data;
+}
+
+QVector<TableRow> decode(const QByteArray &data, bool *ok)
+{
+    if (ok) *ok = false;
+
+    QDataStream stream(data);
+    stream.setVersion(QDataStream::Qt_5_12);
+
+    quint32 magic = 0;
+    quint32 count = 0;
+    quint8 flags = 0;
+    stream >> magic >> count >> flags;
+    if (magic != MAGIC || stream.status() != QDataStream::Ok) return QVector<TableRow>();
+
+    // Each row needs at least a few bytes: don't trust a count bigger than the data
+    if (count > quint32(data.size())) return QVector<TableRow>();
+
+    QVector<TableRow> rows(count);
+
+    // uuids
+    for (TableRow &row: rows)
+    {
+        if (flags & BINARY_UUIDS)
+        {
+            char bytes[16];
+            if (stream.readRawData(bytes, 16) != 16) return QVector<TableRow>();
+            row.uuid = QUuid::fromRfc4122(QByteArray::fromRawData(bytes, 16)).toString(QUuid::WithoutBraces);
+        }
+        else
+        {
+            QByteArray uuid;
+            stream >> uuid;
+            row.uuid = QString::fromUtf8(uuid);
+        }
+    }
+
+    // dates
+    for (TableRow &row: rows)
+    {
+        if (flags & EPOCH_DATES)
+        {
+            qint64 date;
+            stream >> date;
+            row.modified = QDateTime::fromSecsSinceEpoch(date, Qt::UTC).toString(DATE_FORMAT);
+        }
+        else
+        {
+            QByteArray date;
+            stream >> date;
+            row.modified = QString::fromUtf8(date);
+        }
+    }
+
+    // removed
+    for (TableRow &row: rows)
+    {
+        quint8 removed;
+        stream >> removed;
+        row.removed = removed;
+    }
+
+    // user names
+    quint32 dictionaryCount = 0;
+    stream >> dictionaryCount;
+    if (stream.status() != QDataStream::Ok || dictionaryCount > count) return QVector<TableRow>();
+    QStringList dictionary;
+    for (quint32 i = 0; i < dictionaryCount; i++)
+    {
+        QByteArray userName;
+        stream >> userName;
+        dictionary << QString::fromUtf8(userName);
+    }
+    for (TableRow &row: rows)
+    {
+        quint32 index;
+        if (flags & SHORT_DICTIONARY)
+        {
+            quint16 shortIndex;
+            stream >> shortIndex;
+            index = shortIndex;
+        }
+        else stream >> index;
+        if (index >= quint32(dictionary.count())) return QVector<TableRow>();
+        row.userName = dictionary.at(index);
+    }
+
+    // data
+    for (TableRow &row: rows)
+    {
+        QByteArray rowData;
+        stream >> rowData;
+        row.data = QString::fromUtf8(rowData);
+    }
+
+    if (stream.status() != QDataStream::Ok) return QVector<TableRow>();
+
+    if (ok) *ok = true;
+    return rows;
+}
+
+};
@@ -0,0 +1,32 @@
+#ifndef TABLEROWCODEC_H
+#define TABLEROWCODEC_H
+
+#include <QByteArray>
+#include <QVector>
+
+#include "datastruct.h"
+
+/**
+ * @brief TableRowCodec encodes batches of TableRows in a compact columnar binary format,
+ * used for the sync traffic when the server supports it (JSON is used otherwise).
+ * Each column is stored contiguously:
+ * uuids as 16 bytes, modification dates as epoch seconds (UTC), removed flags as single bytes,
+ * user names as a dictionary and indices, data as length-prefixed UTF-8.
+ * Uuids and dates which can't be converted without loss are kept as strings for the whole batch.
+ */
+namespace TableRowCodec
+{
+    /**
+     * @brief formatName The name of the format, as negotiated with the server
+     */
+    const char *formatName();
+
+    QByteArray encode(const QVector<TableRow> &rows);
+    /**
+     * @brief decode
+     * @param ok Set to false if the data is not a valid batch
+     */
+    QVector<TableRow> decode(const QByteArray &data, bool *ok = nullptr);
+};
+
+#endif // TABLEROWCODEC_H
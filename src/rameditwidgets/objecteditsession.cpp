@@ -0,0 +1,15 @@
+#include "objecteditsession.h"
+
+ObjectEditSession::ObjectEditSession(RamAbstractObject *o)
+{
+    if (o)
+    {
+        o->beginEdit();
+        m_obj = o;
+    }
+}
+
+ObjectEditSession::~ObjectEditSession()
+{
+    if (m_obj) m_obj->endEdit();
+}
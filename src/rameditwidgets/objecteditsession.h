@@ -0,0 +1,20 @@
+#ifndef OBJECTEDITSESSION_H
+#define OBJECTEDITSESSION_H
+
+#include "ramabstractobject.h"
+
+/**
+ * @brief The ObjectEditSession class groups the changes made to an object while it exists:
+ * the data is serialized and written only once, when the session is destroyed.
+ */
+class ObjectEditSession
+{
+public:
+    ObjectEditSession(RamAbstractObject *o);
+    ~ObjectEditSession();
+private:
+    Q_DISABLE_COPY(ObjectEditSession)
+    RamAbstractObject *m_obj = nullptr;
+};
+
+#endif // OBJECTEDITSESSION_H
@@ -7,6 +7,7 @@
 #include "ramses.h"
 #include "ramworkingfolder.h"
 #include "ramobjectdelegate.h"
+#include "objecteditsession.h"
 
 StatusEditWidget::StatusEditWidget(QWidget *parent) :
     ObjectEditWidget( parent)
@@ -209,6 +210,8 @@ void StatusEditWidget::setState(RamState *state)
         ui_completionBox->setValue(50);
     }
     if (!m_status || m_reinit) return;
+    // Save all the changes at once
+    ObjectEditSession editSession(m_status);
 
     m_status->setState(state);
     m_status->setCompletionRatio(ui_completionBox->value());
@@ -225,6 +228,8 @@ void StatusEditWidget::refresh()
 void StatusEditWidget::setVersion( int v )
 {
     if (!m_status || m_reinit) return;
+    // Save all the changes at once
+    ObjectEditSession editSession(m_status);
     bool p = m_status->workingFolder().isPublished(v);
     ui_publishedBox->setChecked(p);
     m_status->setVersion(v);
@@ -236,6 +241,8 @@ void StatusEditWidget::setVersion( int v )
 void StatusEditWidget::setCompletion(int c)
 {
     if (!m_status || m_reinit) return;
+    // Save all the changes at once
+    ObjectEditSession editSession(m_status);
     m_status->setCompletionRatio(c);
 
     RamUser *currentUser = Ramses::instance()->currentUser();
@@ -245,6 +252,8 @@ void StatusEditWidget::setCompletion(int c)
 void StatusEditWidget::setComment()
 {
     if (!m_status || m_reinit) return;
+    // Save all the changes at once
+    ObjectEditSession editSession(m_status);
 #if (QT_VERSION < QT_VERSION_CHECK(5, 15, 0))
     m_status->setComment( ui_statusCommentEdit->toPlainText() );
 #else
@@ -258,6 +267,8 @@ void StatusEditWidget::setComment()
 void StatusEditWidget::assignUser(RamObject *u)
 {
     if (!m_status || m_reinit) return;
+    // Save all the changes at once
+    ObjectEditSession editSession(m_status);
     m_status->assignUser(u);
 
     RamUser *currentUser = Ramses::instance()->currentUser();
@@ -267,6 +278,8 @@ void StatusEditWidget::assignUser(RamObject *u)
 void StatusEditWidget::setPublished(bool p)
 {
     if (!m_status || m_reinit) return;
+    // Save all the changes at once
+    ObjectEditSession editSession(m_status);
     m_status->setPublished(p);
 
     RamUser *currentUser = Ramses::instance()->currentUser();
@@ -276,6 +289,8 @@ void StatusEditWidget::setPublished(bool p)
 void StatusEditWidget::setAutoEstimation(bool a)
 {
     if (!m_status) return;
+    // Save all the changes at once
+    ObjectEditSession editSession(m_status);
 
     if (!m_reinit) m_status->setUseAutoEstimation(a);
 
@@ -302,6 +317,8 @@ void StatusEditWidget::setAutoEstimation(bool a)
 void StatusEditWidget::setEstimation(double e)
 {
     if (!m_status || m_reinit) return;
+    // Save all the changes at once
+    ObjectEditSession editSession(m_status);
     m_status->setGoal(e);
 
     RamUser *currentUser = Ramses::instance()->currentUser();
@@ -311,6 +328,8 @@ void StatusEditWidget::setEstimation(double e)
 void StatusEditWidget::setDifficulty(int d)
 {
     if (!m_status || m_reinit) return;
+    // Save all the changes at once
+    ObjectEditSession editSession(m_status);
     switch(d)
     {
     case 0:
@@ -352,6 +371,8 @@ void StatusEditWidget::setDifficulty(int d)
 void StatusEditWidget::setUseDueDate(bool u)
 {
     if (!m_status || m_reinit) return;
+    // Save all the changes at once
+    ObjectEditSession editSession(m_status);
 
     m_status->setUseDueDate(u);
     ui_dueDateEdit->setEnabled(u);
@@ -363,6 +384,8 @@ void StatusEditWidget::setUseDueDate(bool u)
 void StatusEditWidget::setDueDate()
 {
     if (!m_status || m_reinit) return;
+    // Save all the changes at once
+    ObjectEditSession editSession(m_status);
 
     m_status->setDueDate( ui_dueDateEdit->date() );
 
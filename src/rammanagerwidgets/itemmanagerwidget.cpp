@@ -2,6 +2,8 @@
 
 #include "duqf-utils/guiutils.h"
 #include "duqf-widgets/duicon.h"
+#include "dbwritebatch.h"
+#include "objecteditsession.h"
 #include "ramasset.h"
 #include "ramses.h"
 #include "ramassetgroup.h"
@@ -377,9 +379,12 @@ void ItemManagerWidget::sortByPriority(bool sort)
 void ItemManagerWidget::unassignUser()
 {
     QVector<RamStatus*> status = beginEditSelectedStatus();
+    // Save all changes at once
+    DBWriteBatch batch;
     RamUser *currentUser = Ramses::instance()->currentUser();
     for (int i = 0; i < status.count(); i++)
     {
+        ObjectEditSession editSession(status.at(i));
         status.at(i)->assignUser(nullptr);
         status.at(i)->setModifiedBy(currentUser);
     }
@@ -390,6 +395,8 @@ void ItemManagerWidget::assignUser(RamObject *user)
     if (!user) return;
 
     QVector<RamStatus*> status = beginEditSelectedStatus();
+    // Save all changes at once
+    DBWriteBatch batch;
 
     m_project->suspendEstimations(true);
 
@@ -397,6 +404,7 @@ void ItemManagerWidget::assignUser(RamObject *user)
 
     for (int i = 0; i < status.count(); i++)
     {
+        ObjectEditSession editSession(status.at(i));
         status.at(i)->assignUser(user);
         status.at(i)->setModifiedBy(currentUser);
     }
@@ -409,6 +417,8 @@ void ItemManagerWidget::changeState(RamObject *stt)
     if (!stt) return;
 
     QVector<RamStatus*> status = beginEditSelectedStatus();
+    // Save all changes at once
+    DBWriteBatch batch;
 
     m_project->suspendEstimations(true);
 
@@ -416,6 +426,7 @@ void ItemManagerWidget::changeState(RamObject *stt)
 
     for (int i = 0; i < status.count(); i++)
     {
+        ObjectEditSession editSession(status.at(i));
         status.at(i)->setState(RamState::c( stt ));
         status.at(i)->setModifiedBy(currentUser);
     }
@@ -451,6 +462,8 @@ void ItemManagerWidget::setVeryHard()
 void ItemManagerWidget::setDiffculty(RamStatus::Difficulty difficulty)
 {
     QVector<RamStatus*> status = beginEditSelectedStatus();
+    // Save all changes at once
+    DBWriteBatch batch;
 
     m_project->suspendEstimations(true);
 
@@ -458,6 +471,7 @@ void ItemManagerWidget::setDiffculty(RamStatus::Difficulty difficulty)
 
     for (int i = 0; i < status.count(); i++)
     {
+        ObjectEditSession editSession(status.at(i));
         status.at(i)->setDifficulty( difficulty );
         status.at(i)->setModifiedBy(currentUser);
     }
@@ -470,6 +484,8 @@ void ItemManagerWidget::setCompletion()
     QAction* action = qobject_cast<QAction*>( sender() );
     int completion = action->data().toInt();
     QVector<RamStatus*> status = beginEditSelectedStatus();
+    // Save all changes at once
+    DBWriteBatch batch;
 
     m_project->suspendEstimations(true);
 
@@ -477,6 +493,7 @@ void ItemManagerWidget::setCompletion()
 
     for (int i = 0; i < status.count(); i++)
     {
+        ObjectEditSession editSession(status.at(i));
         status.at(i)->setCompletionRatio( completion );
         status.at(i)->setModifiedBy(currentUser);
     }
@@ -489,6 +506,8 @@ void ItemManagerWidget::setPriority()
     QAction* action = qobject_cast<QAction*>( sender() );
     auto priority = static_cast<RamStatus::Priority>( action->data().toInt() );
     QVector<RamStatus*> status = beginEditSelectedStatus();
+    // Save all changes at once
+    DBWriteBatch batch;
 
     m_project->suspendEstimations(true);
 
@@ -496,6 +515,7 @@ void ItemManagerWidget::setPriority()
 
     for (int i = 0; i < status.count(); i++)
     {
+        ObjectEditSession editSession(status.at(i));
         status.at(i)->setPriority( priority );
         status.at(i)->setModifiedBy(currentUser);
     }
@@ -538,6 +558,8 @@ void ItemManagerWidget::pasteComment()
     if (comment == "") return;
 
     QVector<RamStatus*> status = beginEditSelectedStatus();
+    // Save all changes at once
+    DBWriteBatch batch;
 
     m_project->suspendEstimations(true);
 
@@ -545,6 +567,7 @@ void ItemManagerWidget::pasteComment()
 
     for (int i = 0; i < status.count(); i++)
     {
+        ObjectEditSession editSession(status.at(i));
         status.at(i)->setComment( comment );
         status.at(i)->setModifiedBy(currentUser);
     }
@@ -611,6 +634,9 @@ void ItemManagerWidget::deleteItems()
 
     if ( confirm != QMessageBox::Yes) return;
 
+    // Save all changes at once
+    DBWriteBatch batch;
+
     m_project->suspendEstimations(true);
 
     for (int i = 0; i < selection.count(); i++)
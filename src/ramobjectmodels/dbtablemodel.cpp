@@ -42,6 +42,7 @@ void DBTableModel::load()
     connect(ldi, &LocalDataInterface::inserted, this, &DBTableModel::insertObject);
     connect(ldi, &LocalDataInterface::removed, this, &DBTableModel::removeObject);
     connect(ldi, &LocalDataInterface::dataChanged, this, &DBTableModel::changeData);
+    connect(ldi, &LocalDataInterface::transactionCommitted, this, &DBTableModel::flushChangedData);
     if (m_isProjectTable) connect(ldi, &LocalDataInterface::dataResetProject, this, &DBTableModel::reload);
     else connect(ldi, &LocalDataInterface::dataResetCommon, this, &DBTableModel::reload);
 }
@@ -50,7 +51,7 @@ int DBTableModel::rowCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
 
-    return m_objectUuids.count();
+    return m_objectIds.count();
 }
 
 int DBTableModel::columnCount(const QModelIndex &parent) const
@@ -67,11 +68,10 @@ QVariant DBTableModel::data(const QModelIndex &index, int role) const
     if (row < 0) return QVariant();
     else if (row >= rowCount()) return QVariant();
 
-    QString uuid = m_objectUuids.at(row);
-    if (role == RamObject::UUID) return uuid;
+    if (role == RamObject::UUID) return getUuid(row);
 
     // For other roles, we need the actual object
-    RamObject *obj = RamObject::get(uuid, m_table);
+    RamObject *obj = get(row);
     if (obj)
     {
         if (role == RamObject::Pointer) return reinterpret_cast<quintptr>(obj);
@@ -80,7 +80,7 @@ QVariant DBTableModel::data(const QModelIndex &index, int role) const
 
     // Object does not exist
     if (role == RamObject::Pointer) return 0;
-    return uuid;
+    return getUuid(row);
 }
 
 QVariant DBTableModel::headerData(int section, Qt::Orientation orientation, int role) const
@@ -94,11 +94,10 @@ QVariant DBTableModel::headerData(int section, Qt::Orientation orientation, int
     if (section < 0) return QVariant();
     if (section >= rowCount()) return QVariant();
 
-    QString uuid = m_objectUuids.at(section);
-    if (role == RamObject::UUID) return uuid;
+    if (role == RamObject::UUID) return getUuid(section);
 
     // For other roles, we need the actual object
-    RamObject *obj = RamObject::get(uuid, m_table);
+    RamObject *obj = get(section);
     if (obj)
     {
         if (role == RamObject::Pointer) return reinterpret_cast<quintptr>(obj);
@@ -169,7 +168,7 @@ void DBTableModel::removeObjects(QStringList uuids, const QString &table)
     {
         QString uuid = uuids.takeLast();
 
-        int i = m_objectUuids.indexOf(uuid);
+        int i = uuidRow(uuid);
 
         beginRemoveRows(QModelIndex(), i, i);
 
@@ -288,7 +287,7 @@ void DBTableModel::insertObject(const QString &uuid, const QString &data, const
     if (table != m_table) return;
 
     // Already have it
-    if (m_objectUuids.contains(uuid)) return;
+    if (contains(uuid)) return;
 
     // Removed
     if (DBInterface::instance()->isRemoved(uuid, table)) return;
@@ -308,7 +307,7 @@ void DBTableModel::insertObject(const QString &uuid, const QString &data, const
     if (!checkFilters(data)) return;
 
     // Check order
-    int order = m_objectUuids.count();
+    int order = rowCount();
     if (m_userOrder) order = getOrder(data);
 
     // Insert
@@ -384,7 +383,7 @@ void DBTableModel::changeData(const QString &uuid, const QString &data, const QS
     // Not for us
     if (table != "" && table != m_table) return;
 
-    if (!m_objectUuids.contains(uuid))
+    if (!contains(uuid))
     {
         // This may be a new object to insert according to the filters
         if (!checkFilters(data)) return;
@@ -394,7 +393,7 @@ void DBTableModel::changeData(const QString &uuid, const QString &data, const QS
 
     // Check if the order has changed
     int order = getOrder(data);
-    int currentOrder = m_objectUuids.indexOf(uuid);
+    int currentOrder = uuidRow(uuid);
     if (order >= 0 && order != currentOrder)
     {
         if (order >= rowCount()) order = rowCount()-1;
@@ -404,11 +403,39 @@ void DBTableModel::changeData(const QString &uuid, const QString &data, const QS
     // Update stored data
     RamAbstractObjectModel::updateObject(uuid, data);
 
+    // Wait for the end of the transaction to emit all changes at once
+    if (LocalDataInterface::instance()->isFlushingTransaction())
+    {
+        m_changedUuids.insert(uuid);
+        return;
+    }
+
     // Emit data changed
-    QModelIndex i = index( m_objectUuids.indexOf(uuid), 0);
+    QModelIndex i = index( uuidRow(uuid), 0);
     emit dataChanged(i, i, QVector<int>());
 }
 
+void DBTableModel::flushChangedData()
+{
+    if (m_changedUuids.isEmpty()) return;
+
+    // Get the range of changed rows
+    int first = -1;
+    int last = -1;
+    for (const QString &uuid: qAsConst(m_changedUuids))
+    {
+        int row = uuidRow(uuid);
+        if (row < 0) continue;
+        if (first < 0 || row < first) first = row;
+        if (row > last) last = row;
+    }
+    m_changedUuids.clear();
+
+    if (first < 0) return;
+
+    emit dataChanged(index(first, 0), index(last, 0), QVector<int>());
+}
+
 bool objSorter(const QStringList a, const QStringList b)
 {
     QString dataA = a[1];
@@ -61,6 +61,8 @@ protected slots:
     void reload();
     // Checks and changes the data
     void changeData(const QString &uuid, const QString &data, const QString &modificationDate, const QString &table = "");
+    // Emits a single dataChanged for all the objects changed in a transaction
+    void flushChangedData();
 
 private:
 
@@ -98,6 +100,8 @@ private:
     bool m_isLoaded = false;
     bool m_isProjectTable = false;
     bool m_userOrder = false;
+    // Objects changed during the current transaction commit
+    QSet<QString> m_changedUuids;
 };
 
 bool objSorter(const QStringList a, const QStringList b);
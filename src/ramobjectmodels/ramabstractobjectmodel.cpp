@@ -1,6 +1,7 @@
 #include "ramabstractobjectmodel.h"
 
 #include "ramobjectmodel.h"
+#include "ramobjectregistry.h"
 
 RamAbstractObjectModel *RamAbstractObjectModel::m_emptyModel = nullptr;
 
@@ -14,9 +15,15 @@ RamAbstractObjectModel::RamAbstractObjectModel(RamAbstractObject::ObjectType typ
     : QAbstractTableModel{parent}
 {
     m_table = RamAbstractObject::objectTypeName(type);
+    m_tableType = type;
     addLookUpKey("shortName");
 }
 
+RamAbstractObjectModel::~RamAbstractObjectModel()
+{
+    for (int id: qAsConst(m_objectIds)) RamObjectRegistry::release(id);
+}
+
 void RamAbstractObjectModel::addLookUpKey(const QString &newLookUpKey)
 {
     if (!m_lookUpTables.contains(newLookUpKey))
@@ -32,19 +39,20 @@ QString RamAbstractObjectModel::getUuid(int row) const
 {
     if (row < 0) return "";
     if (row >= rowCount()) return "";
-    return m_objectUuids.at(row);
+    return RamObjectRegistry::uuid( m_objectIds.at(row) );
 }
 
 RamObject *RamAbstractObjectModel::get(int row) const
 {
-    QString uuid = getUuid(row);
-    if (uuid == "") return nullptr;
-    return RamObject::get(uuid, type());
+    if (row < 0) return nullptr;
+    if (row >= rowCount()) return nullptr;
+    return objectFromId( m_objectIds.at(row) );
 }
 
 void RamAbstractObjectModel::clear()
 {
-    m_objectUuids.clear();
+    for (int id: qAsConst(m_objectIds)) RamObjectRegistry::release(id);
+    m_objectIds.clear();
     // Clear lookup tables
     QHash<QString, QMultiHash<QString, QString>>::iterator i = m_lookUpTables.begin();
     while (i != m_lookUpTables.end())
@@ -66,16 +74,14 @@ RamObject *RamAbstractObjectModel::search(QString searchString) const
         {
             QString uuid = uuids.at(i);
             if (uuid == "") continue;
-            RamObject *o = RamObject::get(uuid, m_table);
+            RamObject *o = RamObject::get(uuid, m_tableType);
             if (!o) continue;
             if (o->shortName() == searchString) return o;
         }
     }
-    for (int i = 0; i < m_objectUuids.count(); i++)
+    for (int i = 0; i < m_objectIds.count(); i++)
     {
-        QString uuid = m_objectUuids.at(i);
-        if (uuid == "") continue;
-        RamObject *o = RamObject::get(uuid, m_table);
+        RamObject *o = objectFromId( m_objectIds.at(i) );
         if (!o) continue;
         if (o->shortName() == searchString) return o;
     }
@@ -89,16 +95,14 @@ RamObject *RamAbstractObjectModel::search(QString searchString) const
         {
             QString uuid = uuids.at(i);
             if (uuid == "") continue;
-            RamObject *o = RamObject::get(uuid, m_table);
+            RamObject *o = RamObject::get(uuid, m_tableType);
             if (!o) continue;
             if (o->name() == searchString) return o;
         }
     }
-    for (int i = 0; i < m_objectUuids.count(); i++)
+    for (int i = 0; i < m_objectIds.count(); i++)
     {
-        QString uuid = m_objectUuids.at(i);
-        if (uuid == "") continue;
-        RamObject *o = RamObject::get(uuid, m_table);
+        RamObject *o = objectFromId( m_objectIds.at(i) );
         if (!o) continue;
         if (o->name() == searchString) return o;
     }
@@ -116,7 +120,7 @@ QSet<RamObject *> RamAbstractObjectModel::lookUp(QString lookUpKey, QString look
     {
         QString uuid = uuids.at(i);
         if (uuid == "") continue;
-        RamObject *o = RamObject::get(uuid, m_table);
+        RamObject *o = RamObject::get(uuid, m_tableType);
         if (!o) continue;
         objs << o;
     }
@@ -125,22 +129,28 @@ QSet<RamObject *> RamAbstractObjectModel::lookUp(QString lookUpKey, QString look
 
 QVector<QString> RamAbstractObjectModel::toVector() const
 {
-    return m_objectUuids.toVector();
+    QVector<QString> uuids;
+    uuids.reserve(m_objectIds.count());
+    for (int id: qAsConst(m_objectIds)) uuids << RamObjectRegistry::uuid(id);
+    return uuids;
 }
 
 QStringList RamAbstractObjectModel::toStringList() const
 {
-    return m_objectUuids;
+    QStringList uuids;
+    uuids.reserve(m_objectIds.count());
+    for (int id: qAsConst(m_objectIds)) uuids << RamObjectRegistry::uuid(id);
+    return uuids;
 }
 
 bool RamAbstractObjectModel::contains(QString uuid) const
 {
-    return m_objectUuids.contains(uuid);
+    return uuidRow(uuid) >= 0;
 }
 
 RamAbstractObject::ObjectType RamAbstractObjectModel::type() const
 {
-    return RamObject::objectTypeFromName( m_table );
+    return m_tableType;
 }
 
 int RamAbstractObjectModel::objectRow(RamObject *obj) const
@@ -151,20 +161,23 @@ int RamAbstractObjectModel::objectRow(RamObject *obj) const
 
 int RamAbstractObjectModel::uuidRow(QString uuid) const
 {
-    return m_objectUuids.indexOf(uuid);
+    int id = RamObjectRegistry::findId(uuid);
+    if (id < 0) return -1;
+    return m_objectIds.indexOf(id);
 }
 
 void RamAbstractObjectModel::insertObject(int row, QString uuid, QString data)
 {
     // Add to list
-    if (!m_objectUuids.contains(uuid)) m_objectUuids.insert(row, uuid);
+    if (!contains(uuid)) m_objectIds.insert(row, RamObjectRegistry::retain(uuid));
     insertObjectInLookUp(uuid, data);
 }
 
 void RamAbstractObjectModel::removeObject(QString uuid)
 {
-    // Remove from uuid list
-    m_objectUuids.removeAll(uuid);
+    // Remove from id list
+    int row = uuidRow(uuid);
+    if (row >= 0) RamObjectRegistry::release( m_objectIds.takeAt(row) );
     // Remove from lookup table
     removeObjectFromLookUp(uuid);
 }
@@ -187,14 +200,26 @@ void RamAbstractObjectModel::moveObjects(int from, int count, int to)
     for (int i = 0; i < count ; i++)
     {
         if (to < from) {
-            m_objectUuids.move(sourceEnd, to);
+            m_objectIds.move(sourceEnd, to);
         }
         else {
-            m_objectUuids.move(from, to);
+            m_objectIds.move(from, to);
         }
     }
 }
 
+RamObject *RamAbstractObjectModel::objectFromId(int id) const
+{
+    // A loaded object is found by index
+    RamObject *o = RamObjectRegistry::get<RamObject>(id, m_tableType);
+    if (o) return o;
+
+    // Load it
+    QString uuid = RamObjectRegistry::uuid(id);
+    if (uuid == "") return nullptr;
+    return RamObject::get(uuid, m_tableType);
+}
+
 QString RamAbstractObjectModel::getLookUpValue(QString key, QString data)
 {
     QJsonDocument doc = QJsonDocument::fromJson( data.toUtf8() );
@@ -13,6 +13,8 @@ public:
     static RamAbstractObjectModel *emptyModel();
 
     explicit RamAbstractObjectModel(RamObject::ObjectType type, QObject *parent = nullptr);
+    // Releases the ids of the objects
+    virtual ~RamAbstractObjectModel();
 
     // === Parameters ===
 
@@ -62,6 +64,9 @@ protected:
     void updateObject(QString uuid, QString data);
     void moveObjects(int from, int count, int to);
 
+    // The object with this id, loaded if needed
+    RamObject *objectFromId(int id) const;
+
     // Gets the lookUp key value from the data
     QString getLookUpValue(QString key, QString data);
     // Remove an object from the lookup table
@@ -75,8 +80,8 @@ protected:
 
     // === The Data ===
 
-    // All Uuids, sorted
-    QStringList m_objectUuids;
+    // All the ids of the objects (from the RamObjectRegistry), sorted
+    QVector<int> m_objectIds;
     // Fast LookUp table (key / uuid)
     QHash<QString, QMultiHash<QString, QString>> m_lookUpTables;
 
@@ -84,6 +89,8 @@ protected:
 
     // The table name
     QString m_table;
+    // The type, to get the objects without converting the table name
+    RamAbstractObject::ObjectType m_tableType;
 };
 
 #endif // RAMABSTRACTOBJECTMODEL_H
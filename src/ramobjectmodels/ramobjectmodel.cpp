@@ -21,7 +21,7 @@ void RamObjectModel::setLookupRole(int role)
 int RamObjectModel::rowCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent);
-    return m_objectUuids.count();
+    return m_objectIds.count();
 }
 
 int RamObjectModel::columnCount(const QModelIndex &parent) const
@@ -35,17 +35,14 @@ QVariant RamObjectModel::data(const QModelIndex &index, int role) const
     int row = index.row();
     int col = index.column();
 
-    QString uuid = m_objectUuids.at(row);
-    //RamObject *obj = m_objects.at(row);
-    RamObject *obj = nullptr;
-    if (uuid != "") obj = RamObject::get(uuid, m_table);
+    RamObject *obj = get(row);
 
     if (role == RamObject::Pointer) {
         if (obj) return reinterpret_cast<quintptr>(obj);
         return 0;
     }
 
-    if (!obj) return uuid;
+    if (!obj) return getUuid(row);
 
     if (col == 0) return obj->roleData(role);
 
@@ -80,18 +77,17 @@ QVariant RamObjectModel::headerData(int section, Qt::Orientation orientation, in
     // Vertical
     if (orientation == Qt::Vertical)
     {
-        QString uuid = m_objectUuids.at(section);
         if (role == Qt::DisplayRole) {
-            RamObject *obj = getObject(uuid);
+            RamObject *obj = get(section);
             if (obj) return obj->roleData(RamObject::ShortName);
             else return "";
         }
         if (role == RamObject::Pointer) {
-            RamObject *obj = getObject(uuid);
+            RamObject *obj = get(section);
             if (obj) return reinterpret_cast<quintptr>(obj);
             return 0;
         }
-        if (role == RamObject::UUID) return uuid;
+        if (role == RamObject::UUID) return getUuid(section);
         return QAbstractTableModel::headerData(section, orientation, role);
     }
 
@@ -146,7 +142,7 @@ void RamObjectModel::removeObjects(QStringList uuids)
     while (!uuids.isEmpty())
     {
         QString uuid = uuids.takeLast();
-        int i = m_objectUuids.indexOf(uuid);
+        int i = uuidRow(uuid);
         if (i>=0) {
             beginRemoveRows(QModelIndex(), i, i);
 
@@ -192,11 +188,11 @@ bool RamObjectModel::moveRows(const QModelIndex &sourceParent, int sourceRow, in
     for (int i = 0; i < count ; i++)
     {
         if (destinationChild < sourceRow) {
-            m_objectUuids.move(sourceEnd, destinationChild);
+            m_objectIds.move(sourceEnd, destinationChild);
             m_objects.move(sourceEnd, destinationChild);
         }
         else {
-            m_objectUuids.move(sourceRow, destinationChild);
+            m_objectIds.move(sourceRow, destinationChild);
             m_objects.move(sourceRow, destinationChild);
         }
     }
@@ -212,9 +208,9 @@ void RamObjectModel::clear()
 
     beginResetModel();
 
-    while(m_objectUuids.count() > 0)
+    for (int i = 0; i < rowCount(); i++)
     {
-        disconnectObject( m_objectUuids.takeLast() );
+        disconnectObject( getUuid(i) );
     }
 
     RamAbstractObjectModel::clear();
@@ -224,7 +220,7 @@ void RamObjectModel::clear()
 
 void RamObjectModel::appendObject(QString uuid)
 {
-    if (m_objectUuids.contains(uuid)) return;
+    if (contains(uuid)) return;
 
     insertObjects(
                 rowCount(),
@@ -244,10 +240,9 @@ RamObject::ObjectType RamObjectModel::type() const
 
 void RamObjectModel::objectDataChanged(RamObject *obj)
 {
-    QString uuid = obj->uuid();
     // Get the coordinates
-    int row = m_objectUuids.indexOf(uuid);
-    if (row >= 0 && row < m_objectUuids.count())
+    int row = objectRow(obj);
+    if (row >= 0 && row < rowCount())
     {
         QModelIndex i = index(row, 0);
         QModelIndex iEnd = index(row, columnCount() -1);
@@ -273,6 +268,23 @@ void RamObjectModel::columnDataChanged(RamObject *obj)
     }
 }
 
+void RamObjectModel::itemStatusChanged(RamAbstractItem *item, RamStep *step)
+{
+    int row = objectRow(item);
+    if (row < 0) return;
+
+    // Only the cell of the status
+    for (int i = 0; i < m_columnObjects->rowCount(); i++)
+    {
+        if (step->is( m_columnObjects->get(i)))
+        {
+            QModelIndex cell = index(row, i+1);
+            emit dataChanged(cell, cell);
+            return;
+        }
+    }
+}
+
 void RamObjectModel::insertModelColumns(const QModelIndex &parent, int first, int last)
 {
     beginInsertColumns(parent, first+1, last+1);
@@ -313,6 +325,8 @@ void RamObjectModel::connectObject(QString uuid)
 void RamObjectModel::connectObject(RamObject *o)
 {
     connect(o, &RamObject::dataChanged, this, &RamObjectModel::objectDataChanged);
+    RamAbstractItem *item = qobject_cast<RamAbstractItem*>( o );
+    if (item) connect(item, &RamAbstractItem::statusChanged, this, &RamObjectModel::itemStatusChanged);
 }
 
 void RamObjectModel::disconnectObject(QString uuid)
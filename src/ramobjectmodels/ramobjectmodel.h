@@ -6,6 +6,9 @@
 #include "ramobject.h"
 #include "ramobjectsortfilterproxymodel.h"
 
+class RamAbstractItem;
+class RamStep;
+
 /**
  * @brief The RamObjectModel class represents a list of RamObjects
  */
@@ -57,6 +60,7 @@ protected:
 private slots:
     void objectDataChanged(RamObject *obj);
     void columnDataChanged(RamObject *obj);
+    void itemStatusChanged(RamAbstractItem *item, RamStep *step);
 
     // Column changes
     void insertModelColumns(const QModelIndex &parent, int first, int last);
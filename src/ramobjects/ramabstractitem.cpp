@@ -1,6 +1,9 @@
 #include "ramabstractitem.h"
 
+#include <QTimer>
+
 #include "ramproject.h"
+#include "ramstatus.h"
 
 // PUBLIC //
 
@@ -35,6 +38,32 @@ RamProject *RamAbstractItem::project() const
     return RamProject::get( getData("project").toString("none") );
 }
 
+// PUBLIC SLOTS //
+
+void RamAbstractItem::statusFieldChanged(RamObject *status)
+{
+    RamStatus *s = RamStatus::c( status );
+    if (!s || !s->step()) return;
+
+    // Coalesce all the fields changed at once
+    if (m_changedStatusSteps.isEmpty())
+        QTimer::singleShot(0, this, &RamAbstractItem::emitStatusChanged);
+    m_changedStatusSteps.insert( s->step()->uuid() );
+}
+
+// PRIVATE SLOTS //
+
+void RamAbstractItem::emitStatusChanged()
+{
+    const QSet<QString> stepUuids = m_changedStatusSteps;
+    m_changedStatusSteps.clear();
+    for (const QString &stepUuid: stepUuids)
+    {
+        RamStep *step = RamStep::get( stepUuid );
+        if (step) emit statusChanged(this, step);
+    }
+}
+
 // PRIVATE //
 
 void RamAbstractItem::construct()
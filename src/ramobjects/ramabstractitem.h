@@ -21,11 +21,26 @@ public:
     RamProject *project() const;
     virtual RamStep::Type productionType() const = 0;
 
+signals:
+    // Emitted when a field of the status of this item for the step changes
+    void statusChanged(RamAbstractItem *, RamStep *);
+
+public slots:
+    // Connected to the fieldChanged() signal of the statuses of this item
+    void statusFieldChanged(RamObject *status);
+
 protected:
     RamAbstractItem(QString uuid, ObjectType type);
 
+private slots:
+    void emitStatusChanged();
+
 private:
     void construct();
+
+    // The steps of the statuses changed since the last statusChanged(),
+    // to emit it only once per status when several fields change
+    QSet<QString> m_changedStatusSteps;
 };
 
 #endif // RAMABSTRACTITEM_H
@@ -5,6 +5,7 @@
 #include "dbinterface.h"
 #include "ramses.h"
 #include "ramnamemanager.h"
+#include "ramobjectregistry.h"
 
 // STATIC //
 
@@ -12,8 +13,6 @@ QRegularExpression RamAbstractObject::m_rxsn = QRegularExpression();
 
 QHash<QString, QPixmap> RamAbstractObject::m_iconPixmaps = QHash<QString, QPixmap>();
 
-QHash<QString, RamAbstractObject*> RamAbstractObject::m_allObjects = QHash<QString, RamAbstractObject*>();
-
 QSet<RamAbstractObject*> RamAbstractObject::m_invalidObjects = QSet<RamAbstractObject*>();
 
 const QString RamAbstractObject::objectTypeName(ObjectType type)
@@ -99,8 +98,7 @@ void RamAbstractObject::setObjectData(QString uuid, QString dataStr)
 {
     // TODO use the localdbinterface instead? (we need the type)
 
-    RamAbstractObject *obj = nullptr;
-    if (m_allObjects.contains(uuid)) obj = m_allObjects[uuid];
+    RamAbstractObject *obj = RamObjectRegistry::object(uuid);
     if (!obj) return;
 
     obj->setDataString(dataStr);
@@ -110,8 +108,7 @@ void RamAbstractObject::setObjectData(QString uuid, QJsonObject data)
 {
     // TODO use the localdbinterface instead? (we need the type)
 
-    RamAbstractObject *obj = nullptr;
-    if (m_allObjects.contains(uuid)) obj = m_allObjects[uuid];
+    RamAbstractObject *obj = RamObjectRegistry::object(uuid);
     if (!obj) return;
 
     obj->setData(data);
@@ -121,8 +118,7 @@ QJsonObject RamAbstractObject::getObjectData(QString uuid)
 {
     // TODO use the localdbinterface instead? (we need the type)
 
-    RamAbstractObject *obj = nullptr;
-    if (m_allObjects.contains(uuid)) obj = m_allObjects[uuid];
+    RamAbstractObject *obj = RamObjectRegistry::object(uuid);
     if (!obj) return QJsonObject();
 
     return obj->data();
@@ -132,8 +128,7 @@ QString RamAbstractObject::getObjectDataString(QString uuid)
 {
     // TODO use the localdbinterface instead? (we need the type)
 
-    RamAbstractObject *obj = nullptr;
-    if (m_allObjects.contains(uuid)) obj = m_allObjects[uuid];
+    RamAbstractObject *obj = RamObjectRegistry::object(uuid);
     if (!obj) return "{}";
 
     return obj->dataString();
@@ -141,8 +136,7 @@ QString RamAbstractObject::getObjectDataString(QString uuid)
 
 QString RamAbstractObject::getObjectPath(QString uuid)
 {
-    RamAbstractObject *obj = nullptr;
-    if (m_allObjects.contains(uuid)) obj = m_allObjects[uuid];
+    RamAbstractObject *obj = RamObjectRegistry::object(uuid);
     if (!obj) return "";
 
     return obj->path();
@@ -154,12 +148,10 @@ const QString RamAbstractObject::uuidFromPath(QString path, ObjectType type)
     if (!path.endsWith("/")) path = path + "/";
 
     // Check the path of all existing ramObjects
-    QHashIterator<QString, RamAbstractObject*> i = QHashIterator<QString, RamAbstractObject*>(m_allObjects);
+    const QVector<RamAbstractObject*> objects = RamObjectRegistry::objects();
     // We'll keep the closest match
-    while (i.hasNext())
+    for (RamAbstractObject *o: objects)
     {
-        i.next();
-        RamAbstractObject *o = i.value();
         if (!o->isValid()) continue;
         if (o->objectType() != type) continue;
 
@@ -194,6 +186,7 @@ RamAbstractObject::RamAbstractObject(QString shortName, QString name, ObjectType
 
 RamAbstractObject::~RamAbstractObject()
 {
+    RamObjectRegistry::remove(this);
     m_settings->deleteLater();
 }
 
@@ -231,6 +224,20 @@ QString RamAbstractObject::objectTypeName() const
 
 QJsonObject RamAbstractObject::data() const
 {
+    // Changed during an edit session
+    if (m_editPending) return m_cachedObject;
+
+    // Parse the cached data only once
+    if (m_cachedData != "" && CACHE_RAMOBJECT_DATA)
+    {
+        if (!m_cachedObjectValid)
+        {
+            m_cachedObject = QJsonDocument::fromJson(m_cachedData.toUtf8()).object();
+            m_cachedObjectValid = true;
+        }
+        return m_cachedObject;
+    }
+
     QString dataStr = dataString();
     if (dataStr == "") return QJsonObject();
 
@@ -245,9 +252,20 @@ QJsonValue RamAbstractObject::getData(QString key) const
 
 void RamAbstractObject::setData(QJsonObject data)
 {
+    // In an edit session, keep the changes until the end
+    if (m_editDepth > 0)
+    {
+        m_cachedObject = data;
+        m_cachedObjectValid = true;
+        m_editPending = true;
+        return;
+    }
+
     QJsonDocument doc = QJsonDocument(data);
     const QString str = doc.toJson(QJsonDocument::Compact);
-    setDataString(str);
+    // We already have the object, no need to parse it again
+    cacheData(str, data);
+    saveData();
 }
 
 void RamAbstractObject::insertData(QString key, QJsonValue value)
@@ -258,6 +276,34 @@ void RamAbstractObject::insertData(QString key, QJsonValue value)
     setData(d);
 }
 
+void RamAbstractObject::beginEdit()
+{
+    m_editDepth++;
+}
+
+void RamAbstractObject::endEdit()
+{
+    if (m_editDepth == 0) return;
+    m_editDepth--;
+    if (m_editDepth > 0) return;
+
+    // Serialize and save only once
+    if (m_editPending)
+    {
+        m_editPending = false;
+        setData(m_cachedObject);
+    }
+
+    const QStringList fields = m_editedFields;
+    m_editedFields.clear();
+    for (const QString &key: fields) emitFieldChanged(key);
+}
+
+bool RamAbstractObject::isEditing() const
+{
+    return m_editDepth > 0;
+}
+
 QString RamAbstractObject::shortName() const
 {
     return getData("shortName").toString("UNKNOWN");
@@ -582,7 +628,7 @@ RamAbstractObject::RamAbstractObject(QString uuid, ObjectType type)
     m_objectType = type;
 
     // cache the data
-    m_cachedData = dataString();
+    cacheData( dataString() );
 
     construct();
 }
@@ -599,10 +645,55 @@ void RamAbstractObject::suspendSave(bool suspend)
 
 void RamAbstractObject::setDataString(QString data)
 {
-    m_savingData = true;
+    // Edit sessions keep the parsed data
+    if (m_editDepth > 0)
+    {
+        setData( QJsonDocument::fromJson(data.toUtf8()).object() );
+        return;
+    }
 
     // Cache the data to improve performance
-    m_cachedData = data;
+    cacheData(data);
+    saveData();
+}
+
+void RamAbstractObject::revertData()
+{
+    // An edit session in progress will save its own data
+    if (m_editPending) return;
+
+    cacheData( DBInterface::instance()->objectData(m_uuid, objectTypeName()) );
+    emitDataChanged();
+}
+
+void RamAbstractObject::cacheData(const QString &dataStr)
+{
+    m_cachedData = dataStr;
+    m_cachedObjectValid = false;
+}
+
+void RamAbstractObject::cacheData(const QString &dataStr, const QJsonObject &dataObj)
+{
+    m_cachedData = dataStr;
+    m_cachedObject = dataObj;
+    m_cachedObjectValid = true;
+}
+
+void RamAbstractObject::notifyFieldChanged(const QString &key)
+{
+    if (m_editDepth > 0)
+    {
+        if (!m_editedFields.contains(key)) m_editedFields << key;
+        return;
+    }
+    emitFieldChanged(key);
+}
+
+void RamAbstractObject::saveData()
+{
+    m_savingData = true;
+
+    const QString data = m_cachedData;
 
     if (m_virtual || m_saveSuspended || !m_created) return;
 
@@ -623,6 +714,9 @@ void RamAbstractObject::setDataString(QString data)
 
 QString RamAbstractObject::dataString() const
 {
+    // Not serialized yet during an edit session
+    if (m_editPending) return QJsonDocument(m_cachedObject).toJson(QJsonDocument::Compact);
+
     // If we have cached the data already, return it
     if (m_cachedData != "" && CACHE_RAMOBJECT_DATA) return m_cachedData;
 
@@ -642,9 +736,8 @@ void RamAbstractObject::createData(QString data)
     if (m_virtual || m_saveSuspended) return;
 
     if (data == "") data = m_cachedData;
-
     // Cache the data to improve performance
-    m_cachedData = data;
+    else cacheData(data);
 
     DBInterface::instance()->createObject(m_uuid, objectTypeName(), data);
 
@@ -726,5 +819,5 @@ QRegularExpression RamAbstractObject::shortNameRegularExpression()
 
 void RamAbstractObject::construct()
 {
-    m_allObjects[m_uuid] = this;
+    RamObjectRegistry::insert(this);
 }
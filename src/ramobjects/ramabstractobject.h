@@ -2,6 +2,7 @@
 #define RAMABSTRACTOBJECT_H
 
 #include "duqf-widgets/duicon.h"
+#include "ramfield.h"
 #include <QSettings>
 
 /**
@@ -182,6 +183,32 @@ public:
      */
     void insertData(QString key, QJsonValue value);
 
+    /**
+     * @brief field returns the value of a field declared in the Fields of the object type, with its actual type
+     */
+    template<typename T>
+    T field(const RamField<T> &f) const { return f.read( data() ); }
+    /**
+     * @brief setField sets the value of a field declared in the Fields of the object type
+     * and notifies the change of this field
+     */
+    template<typename T>
+    void setField(const RamField<T> &f, const T &value) {
+        QJsonObject d = data();
+        f.write(d, value);
+        setData(d);
+        notifyFieldChanged( QString::fromLatin1(f.key) );
+    }
+
+    /**
+     * @brief beginEdit starts an edit session: the changes are kept in memory,
+     * and serialized and saved only once, by the matching endEdit(), with a single change signal.
+     * Sessions can be nested. Use an ObjectEditSession to make sure endEdit() is called.
+     */
+    void beginEdit();
+    void endEdit();
+    bool isEditing() const;
+
     /**
      * @brief shortName the identifier of the object
      * @return
@@ -257,8 +284,11 @@ public:
     // Low level data handling.
     QString dataString() const;
     void setDataString(QString data);
+    // Drops the cached data and reads it again from the database, when a write has been rolled back
+    void revertData();
 
     virtual void emitDataChanged() {};
+    virtual void emitFieldChanged(const QString &key) { Q_UNUSED(key) };
 
     void suspendSave(bool suspend);
     bool isSaveSuspended() const;
@@ -276,12 +306,23 @@ protected:
     virtual QJsonObject reloadData() = 0;
     void createData(QString data = "");
 
+    /**
+     * @brief cacheData Caches the data string. It will be parsed once, the next time the data is read.
+     */
+    void cacheData(const QString &dataStr);
+    /**
+     * @brief cacheData Caches the data string and the corresponding parsed object.
+     */
+    void cacheData(const QString &dataStr, const QJsonObject &dataObj);
+
+    // Emits fieldChanged, or after the edit session
+    void notifyFieldChanged(const QString &key);
+
     // SIGNALS in QObject instances
     virtual void emitRemoved() = 0;
     virtual void emitRestored() = 0;
 
     // UTILS
-    static QHash<QString, RamAbstractObject*> m_allObjects;
     static QSet<RamAbstractObject*> m_invalidObjects;
     /**
      * @brief folderPath the folder of this object
@@ -307,6 +348,18 @@ protected:
 
 private:
     void construct();
+    // Writes the cached data to the database
+    void saveData();
+
+    // The parsed m_cachedData, to avoid parsing the JSON each time a value is read
+    mutable QJsonObject m_cachedObject;
+    mutable bool m_cachedObjectValid = false;
+
+    // Edit sessions
+    int m_editDepth = 0;
+    // m_cachedObject has changes which are not saved yet
+    bool m_editPending = false;
+    QStringList m_editedFields;
 
     QSettings *m_settings = nullptr;
     bool m_valid = true;
@@ -1,18 +1,17 @@
 #include "ramapplication.h"
 
 #include "applicationeditwidget.h"
+#include "ramobjectregistry.h"
 
 // STATIC //
 
 QFrame *RamApplication::ui_applicationWidget = nullptr;
 
-QHash<QString, RamApplication*> RamApplication::m_existingObjects = QHash<QString, RamApplication*>();
-
 RamApplication *RamApplication::get(QString uuid)
 {
     if (!checkUuid(uuid, Application)) return nullptr;
 
-    RamApplication *a = m_existingObjects.value(uuid);
+    RamApplication *a = RamObjectRegistry::get<RamApplication>(uuid, Application);
     if (a) return a;
 
     // Finally return a new instance
@@ -166,7 +165,6 @@ QString RamApplication::folderPath() const
 
 void RamApplication::construct()
 {
-    m_existingObjects[m_uuid] = this;
     m_icon = ":/icons/application";
     m_editRole = Admin;
 
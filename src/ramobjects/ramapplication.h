@@ -45,7 +45,6 @@ public slots:
     virtual void edit(bool show = true) override;
 
 protected:
-    static QHash<QString, RamApplication*> m_existingObjects;
     /**
      * @brief RamApplication constructs a RamApplication from the database
      * @param uuid
@@ -2,18 +2,17 @@
 
 #include "asseteditwidget.h"
 #include "ramproject.h"
+#include "ramobjectregistry.h"
 
 // STATIC //
 
 QFrame *RamAsset::ui_assetWidget = nullptr;
 
-QHash<QString, RamAsset*> RamAsset::m_existingObjects = QHash<QString, RamAsset*>();
-
 RamAsset *RamAsset::get(QString uuid)
 {
     if (!checkUuid(uuid, Asset)) return nullptr;
 
-    RamAsset *a = m_existingObjects.value(uuid);
+    RamAsset *a = RamObjectRegistry::get<RamAsset>(uuid, Asset);
     if (a) return a;
 
     // Finally return a new instance
@@ -163,7 +162,6 @@ QString RamAsset::folderPath() const
 
 void RamAsset::construct()
 {
-    m_existingObjects[m_uuid] = this;
     m_icon = ":/icons/asset";
     m_editRole = ProjectAdmin;
 }
@@ -41,7 +41,6 @@ public slots:
     virtual void edit(bool show = true) override;
 
 protected:
-    static QHash<QString, RamAsset*> m_existingObjects;
     RamAsset(QString uuid);
     virtual QString folderPath() const override;
 
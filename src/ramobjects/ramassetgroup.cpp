@@ -1,18 +1,17 @@
 #include "ramassetgroup.h"
 
 #include "assetgroupeditwidget.h"
+#include "ramobjectregistry.h"
 
 // STATIC //
 
 QFrame *RamAssetGroup::ui_assetGroupWidget = nullptr;
 
-QHash<QString, RamAssetGroup*> RamAssetGroup::m_existingObjects = QHash<QString, RamAssetGroup*>();
-
 RamAssetGroup *RamAssetGroup::get(QString uuid)
 {
     if (!checkUuid(uuid, AssetGroup)) return nullptr;
 
-    RamAssetGroup *a = m_existingObjects.value(uuid);
+    RamAssetGroup *a = RamObjectRegistry::get<RamAssetGroup>(uuid, AssetGroup);
     if (a) return a;
 
     // Finally return a new instance
@@ -104,7 +103,6 @@ QString RamAssetGroup::folderPath() const
 
 void RamAssetGroup::construct()
 {
-    m_existingObjects[m_uuid] = this;
     m_objectType = AssetGroup;
     m_icon = ":/icons/asset-group";
     m_editRole = ProjectAdmin;
@@ -31,7 +31,6 @@ public slots:
     virtual void edit(bool show = true) override;
 
 protected:
-    static QHash<QString, RamAssetGroup*> m_existingObjects;
     RamAssetGroup(QString uuid);
     virtual QString folderPath() const override;
 
@@ -0,0 +1,91 @@
+#ifndef RAMFIELD_H
+#define RAMFIELD_H
+
+#include <QJsonObject>
+#include <QDateTime>
+
+#include "duqf-app/app-config.h"
+
+/**
+ * @brief The RamFieldType struct converts the values of a RamField from and to JSON.
+ * It's specialized for each type a field can have.
+ */
+template<typename T>
+struct RamFieldType;
+
+template<>
+struct RamFieldType<QString>
+{
+    static QString fromJson(const QJsonValue &v, const QString &d) { return v.toString(d); }
+    static QJsonValue toJson(const QString &v) { return v; }
+};
+
+template<>
+struct RamFieldType<int>
+{
+    static int fromJson(const QJsonValue &v, int d) { return v.toInt(d); }
+    static QJsonValue toJson(int v) { return v; }
+};
+
+template<>
+struct RamFieldType<bool>
+{
+    static bool fromJson(const QJsonValue &v, bool d) { return v.toBool(d); }
+    static QJsonValue toJson(bool v) { return v; }
+};
+
+template<>
+struct RamFieldType<double>
+{
+    static double fromJson(const QJsonValue &v, double d) { return v.toDouble(d); }
+    static QJsonValue toJson(double v) { return v; }
+};
+
+template<>
+struct RamFieldType<float>
+{
+    static float fromJson(const QJsonValue &v, float d) { return v.toDouble(d); }
+    static QJsonValue toJson(float v) { return v; }
+};
+
+template<>
+struct RamFieldType<QDateTime>
+{
+    static QDateTime fromJson(const QJsonValue &v, const QDateTime &d) {
+        if (!v.isString()) return d;
+        return QDateTime::fromString(v.toString(), DATETIME_DATA_FORMAT);
+    }
+    static QJsonValue toJson(const QDateTime &v) { return v.toString(DATETIME_DATA_FORMAT); }
+};
+
+template<>
+struct RamFieldType<QDate>
+{
+    static QDate fromJson(const QJsonValue &v, const QDate &d) {
+        if (!v.isString()) return d;
+        return QDate::fromString(v.toString(), DATE_DATA_FORMAT);
+    }
+    static QJsonValue toJson(const QDate &v) { return v.toString(DATE_DATA_FORMAT); }
+};
+
+/**
+ * @brief The RamField struct declares a field of the data of a RamObject: its key, type and default value.
+ * Each object type lists its fields in a Fields struct,
+ * which are read and written with RamAbstractObject::field() and setField().
+ */
+template<typename T>
+struct RamField
+{
+    const char *key;
+    T defaultValue;
+
+    T read(const QJsonObject &data) const {
+        return RamFieldType<T>::fromJson( data.value(QLatin1String(key)), defaultValue );
+    }
+
+    void write(QJsonObject &data, const T &value) const {
+        data.insert( QString::fromLatin1(key), RamFieldType<T>::toJson(value) );
+    }
+};
+
+#endif // RAMFIELD_H
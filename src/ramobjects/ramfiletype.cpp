@@ -1,18 +1,17 @@
 #include "ramfiletype.h"
 
 #include "filetypeeditwidget.h"
+#include "ramobjectregistry.h"
 
 // STATIC //
 
 QFrame *RamFileType::ui_editWidget = nullptr;
 
-QHash<QString, RamFileType*> RamFileType::m_existingObjects = QHash<QString, RamFileType*>();
-
 RamFileType *RamFileType::get(QString uuid)
 {
     if (!checkUuid(uuid, FileType)) return nullptr;
 
-    RamFileType *f = m_existingObjects.value(uuid);
+    RamFileType *f = RamObjectRegistry::get<RamFileType>(uuid, FileType);
     if (f) return f;
 
     // Finally return a new instance
@@ -118,7 +117,6 @@ void RamFileType::edit(bool show)
 
 void RamFileType::construct()
 {
-    m_existingObjects[m_uuid] = this;
     m_icon = ":/icons/file";
     m_editRole = Admin;
 }
@@ -33,7 +33,6 @@ public slots:
     virtual void edit(bool show = true) override;
 
 protected:
-    static QHash<QString, RamFileType*> m_existingObjects;
      RamFileType(QString uuid);
      virtual QString folderPath() const override { return ""; };
 
@@ -148,6 +148,11 @@ void RamObject::emitDataChanged()
     if (!m_saveSuspended) emit dataChanged(this);
 }
 
+void RamObject::emitFieldChanged(const QString &key)
+{
+    if (!m_saveSuspended) emit fieldChanged(this, key);
+}
+
 void RamObject::emitRemoved()
 {
     emit removed(this);
@@ -218,7 +223,7 @@ void RamObject::checkData(QString uuid, QString d, QString table)
     if (table != objectTypeName()) return;
     if (uuid != m_uuid) return;
     // Update cache!
-    m_cachedData = d;
+    cacheData(d);
     // Reset lists
     QJsonObject dataObj = data();
     QMapIterator<RamObjectModel *, QString> it = QMapIterator<RamObjectModel*, QString>( m_subModels );
@@ -41,6 +41,7 @@ public:
     virtual bool canEdit();
 
     void emitDataChanged() override;
+    void emitFieldChanged(const QString &key) override;
 
 public slots:
     virtual void edit(bool s = true) { Q_UNUSED(s) };
@@ -50,6 +51,9 @@ public slots:
 
 signals:
     void dataChanged(RamObject *);
+    // Emitted after dataChanged() by the setters of the typed fields,
+    // to update only what depends on this field
+    void fieldChanged(RamObject *, QString);
     void removed(RamObject *);
     void restored(RamObject *);
 
@@ -0,0 +1,103 @@
+#include "ramobjectregistry.h"
+
+QHash<QString, int> RamObjectRegistry::m_ids = QHash<QString, int>();
+
+QVector<QString> RamObjectRegistry::m_uuids = QVector<QString>();
+
+QVector<RamAbstractObject*> RamObjectRegistry::m_objects = QVector<RamAbstractObject*>();
+
+QVector<int> RamObjectRegistry::m_refCounts = QVector<int>();
+
+QVector<int> RamObjectRegistry::m_freeIds = QVector<int>();
+
+int RamObjectRegistry::retain(const QString &uuid)
+{
+    int i = m_ids.value(uuid, -1);
+    if (i >= 0)
+    {
+        m_refCounts[i]++;
+        return i;
+    }
+
+    if (!m_freeIds.isEmpty())
+    {
+        i = m_freeIds.takeLast();
+        m_uuids[i] = uuid;
+        m_objects[i] = nullptr;
+        m_refCounts[i] = 1;
+    }
+    else
+    {
+        i = m_uuids.count();
+        m_uuids << uuid;
+        m_objects << nullptr;
+        m_refCounts << 1;
+    }
+
+    m_ids.insert(uuid, i);
+    return i;
+}
+
+void RamObjectRegistry::release(int id)
+{
+    if (id < 0 || id >= m_refCounts.count()) return;
+    if (m_refCounts.at(id) <= 0) return;
+
+    m_refCounts[id]--;
+    if (m_refCounts.at(id) > 0) return;
+
+    // Nothing uses this id anymore
+    m_ids.remove(m_uuids.at(id));
+    m_uuids[id] = QString();
+    m_objects[id] = nullptr;
+    m_freeIds << id;
+}
+
+int RamObjectRegistry::findId(const QString &uuid)
+{
+    return m_ids.value(uuid, -1);
+}
+
+QString RamObjectRegistry::uuid(int id)
+{
+    if (id < 0 || id >= m_uuids.count()) return "";
+    return m_uuids.at(id);
+}
+
+void RamObjectRegistry::insert(RamAbstractObject *o)
+{
+    if (!o) return;
+    int i = findId(o->uuid());
+    // The slot keeps a single reference, even if the object is replaced
+    if (i < 0 || !m_objects.at(i)) i = retain(o->uuid());
+    m_objects[i] = o;
+}
+
+void RamObjectRegistry::remove(RamAbstractObject *o)
+{
+    if (!o) return;
+    int i = findId(o->uuid());
+    if (i < 0 || m_objects.at(i) != o) return;
+    m_objects[i] = nullptr;
+    // The id is kept while a model stores it
+    release(i);
+}
+
+RamAbstractObject *RamObjectRegistry::object(int id)
+{
+    if (id < 0 || id >= m_objects.count()) return nullptr;
+    return m_objects.at(id);
+}
+
+RamAbstractObject *RamObjectRegistry::object(const QString &uuid)
+{
+    return object( findId(uuid) );
+}
+
+QVector<RamAbstractObject *> RamObjectRegistry::objects()
+{
+    QVector<RamAbstractObject*> objs;
+    objs.reserve(m_objects.count());
+    for (RamAbstractObject *o: qAsConst(m_objects)) if (o) objs << o;
+    return objs;
+}
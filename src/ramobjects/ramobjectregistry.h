@@ -0,0 +1,62 @@
+#ifndef RAMOBJECTREGISTRY_H
+#define RAMOBJECTREGISTRY_H
+
+#include "ramabstractobject.h"
+
+/**
+ * @brief The RamObjectRegistry class keeps all the loaded objects, of all types.
+ * Uuids are interned as compact integer ids: an object is found with a single hash lookup from its uuid,
+ * or by index from its id, which can be stored instead of the uuid.
+ * Ids are reference counted: an id is kept while it's retained by an object or a model,
+ * then it's freed and reused for another uuid.
+ */
+class RamObjectRegistry
+{
+public:
+    /**
+     * @brief retain gets the id of a uuid, interns the uuid if it's not known yet,
+     * and keeps the id until it's released
+     */
+    static int retain(const QString &uuid);
+    // Frees the id once it's been released as many times as it's been retained
+    static void release(int id);
+    // The id of a uuid, or -1 if it's not known
+    static int findId(const QString &uuid);
+    static QString uuid(int id);
+
+    static void insert(RamAbstractObject *o);
+    static void remove(RamAbstractObject *o);
+
+    static RamAbstractObject *object(int id);
+    static RamAbstractObject *object(const QString &uuid);
+    // All the loaded objects
+    static QVector<RamAbstractObject*> objects();
+
+    /**
+     * @brief get returns the loaded object with this uuid, only if it has the given type
+     */
+    template<typename T>
+    static T *get(const QString &uuid, RamAbstractObject::ObjectType type) {
+        return get<T>(findId(uuid), type);
+    }
+    /**
+     * @brief get returns the loaded object with this id, only if it has the given type
+     */
+    template<typename T>
+    static T *get(int id, RamAbstractObject::ObjectType type) {
+        RamAbstractObject *o = object(id);
+        if (!o || o->objectType() != type) return nullptr;
+        return static_cast<T*>(o);
+    }
+
+private:
+    static QHash<QString, int> m_ids;
+    // Indexed by id
+    static QVector<QString> m_uuids;
+    static QVector<RamAbstractObject*> m_objects;
+    static QVector<int> m_refCounts;
+    // The ids which have been released, to be reused
+    static QVector<int> m_freeIds;
+};
+
+#endif // RAMOBJECTREGISTRY_H
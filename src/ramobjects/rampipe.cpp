@@ -2,16 +2,15 @@
 
 #include "pipeeditwidget.h"
 #include "ramstep.h"
+#include "ramobjectregistry.h"
 
 QFrame *RamPipe::ui_editWidget = nullptr;
 
-QHash<QString, RamPipe*> RamPipe::m_existingObjects = QHash<QString, RamPipe*>();
-
 RamPipe *RamPipe::get(QString uuid)
 {
     if (!checkUuid(uuid, Pipe)) return nullptr;
 
-    RamPipe *p = m_existingObjects.value(uuid);
+    RamPipe *p = RamObjectRegistry::get<RamPipe>(uuid, Pipe);
     if (p) return p;
 
     // Finally return a new instance
@@ -122,7 +121,6 @@ void RamPipe::edit(bool show)
 
 void RamPipe::construct()
 {
-    m_existingObjects[m_uuid] = this;
     m_icon = ":/icons/connection";
     m_editRole = ProjectAdmin;
 
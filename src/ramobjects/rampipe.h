@@ -36,7 +36,6 @@ public slots:
     virtual void edit(bool show = true) override;
 
 protected:
-    static QHash<QString, RamPipe*> m_existingObjects;
     RamPipe(QString uuid);
     virtual QString folderPath() const override { return ""; };
 
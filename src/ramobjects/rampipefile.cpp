@@ -1,16 +1,15 @@
 #include "rampipefile.h"
 
 #include "pipefileeditwidget.h"
+#include "ramobjectregistry.h"
 
 QFrame *RamPipeFile::ui_editWidget = nullptr;
 
-QHash<QString, RamPipeFile*> RamPipeFile::m_existingObjects = QHash<QString, RamPipeFile*>();
-
 RamPipeFile *RamPipeFile::get(QString uuid)
 {
     if (!checkUuid(uuid, PipeFile)) return nullptr;
 
-    RamPipeFile *p = m_existingObjects.value(uuid);
+    RamPipeFile *p = RamObjectRegistry::get<RamPipeFile>(uuid, PipeFile);
     if (p) return p;
 
     // Finally return a new instance
@@ -132,7 +131,6 @@ void RamPipeFile::edit(bool show)
 
 void RamPipeFile::construct()
 {
-    m_existingObjects[m_uuid] = this;
     m_icon = ":/icons/connection";
     m_editRole = ProjectAdmin;
 }
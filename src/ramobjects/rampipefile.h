@@ -37,7 +37,6 @@ public slots:
     virtual void edit(bool show = true) override;
 
 protected:
-    static QHash<QString, RamPipeFile*> m_existingObjects;
     RamPipeFile(QString uuid);
     virtual QString folderPath() const override { return ""; };
 
@@ -6,16 +6,15 @@
 #include "projecteditwidget.h"
 #include "ramshot.h"
 #include "ramstatustablemodel.h"
+#include "ramobjectregistry.h"
 
 QFrame *RamProject::ui_editWidget = nullptr;
 
-QHash<QString, RamProject*> RamProject::m_existingObjects = QHash<QString, RamProject*>();
-
 RamProject *RamProject::get(QString uuid)
 {
     if (!checkUuid(uuid, Project)) return nullptr;
 
-    RamProject *p = m_existingObjects.value(uuid);
+    RamProject *p = RamObjectRegistry::get<RamProject>(uuid, Project);
     if (p) return p;
 
     // Finally return a new instance
@@ -572,7 +571,6 @@ void RamProject::construct()
 {
     m_estimationFrozen = true;
 
-    m_existingObjects[m_uuid] = this;
     m_icon = ":/icons/project";
     m_editRole = ProjectAdmin;
 
@@ -131,7 +131,6 @@ public slots:
     void suspendEstimations(bool frozen = true, bool recompute = true);
 
 protected:
-    static QHash<QString, RamProject*> m_existingObjects;
     RamProject(QString uuid);
     virtual QString folderPath() const override;
 
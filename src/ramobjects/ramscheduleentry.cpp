@@ -3,16 +3,15 @@
 #include "ramstep.h"
 #include "ramuser.h"
 #include "scheduleentryeditwidget.h"
+#include "ramobjectregistry.h"
 
 QFrame *RamScheduleEntry::ui_editWidget = nullptr;
 
-QHash<QString, RamScheduleEntry*> RamScheduleEntry::m_existingObjects = QHash<QString, RamScheduleEntry*>();
-
 RamScheduleEntry *RamScheduleEntry::get(const QString &uuid)
 {
     if (!checkUuid(uuid, ScheduleEntry)) return nullptr;
 
-    RamScheduleEntry *e = m_existingObjects.value(uuid);
+    RamScheduleEntry *e = RamObjectRegistry::get<RamScheduleEntry>(uuid, ScheduleEntry);
     if (e) return e;
 
     // Finally return a new instance
@@ -212,7 +211,6 @@ RamScheduleEntry::RamScheduleEntry(const QString &uuid):
 
 void RamScheduleEntry::construct()
 {
-    m_existingObjects[m_uuid] = this;
     m_icon = ":/icons/calendar";
     m_editRole = Lead;
 }
@@ -171,7 +171,6 @@ protected:
     /**
      * @brief Schedule Entries Lookup Table by UUID
      */
-    static QHash<QString, RamScheduleEntry*> m_existingObjects;
 
     // UI //
 
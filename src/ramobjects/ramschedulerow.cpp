@@ -1,16 +1,15 @@
 #include "ramschedulerow.h"
 #include "ramuser.h"
 #include "scheduleroweditwidget.h"
+#include "ramobjectregistry.h"
 
 QFrame *RamScheduleRow::ui_editWidget = nullptr;
 
-QHash<QString, RamScheduleRow*> RamScheduleRow::m_existingObjects = QHash<QString, RamScheduleRow*>();
-
 RamScheduleRow *RamScheduleRow::get(QString uuid)
 {
     if (!checkUuid(uuid, ScheduleRow)) return nullptr;
 
-    RamScheduleRow *r = m_existingObjects.value(uuid);
+    RamScheduleRow *r = RamObjectRegistry::get<RamScheduleRow>(uuid, ScheduleRow);
     if (r) return r;
 
     // Finally return a new instance
@@ -103,7 +102,6 @@ RamScheduleRow::RamScheduleRow(const QString &uuid):
 
 void RamScheduleRow::construct()
 {
-    m_existingObjects[m_uuid] = this;
     m_icon = ":/icons/calendar";
     m_editRole = Lead;
 }
@@ -131,7 +131,6 @@ protected:
     /**
      * @brief Schedule Rows Lookup Table by UUID
      */
-    static QHash<QString, RamScheduleRow*> m_existingObjects;
 
     // UI //
 
@@ -1,18 +1,17 @@
 #include "ramsequence.h"
 
 #include "sequenceeditwidget.h"
+#include "ramobjectregistry.h"
 
 // STATIC //
 
 QFrame *RamSequence::ui_editWidget = nullptr;
 
-QHash<QString, RamSequence*> RamSequence::m_existingObjects = QHash<QString, RamSequence*>();
-
 RamSequence *RamSequence::get(QString uuid)
 {
     if (!checkUuid(uuid, Sequence)) return nullptr;
 
-    RamSequence *s = m_existingObjects.value(uuid);
+    RamSequence *s = RamObjectRegistry::get<RamSequence>(uuid, Sequence);
     if (s) return s;
 
     // Finally return a new instance
@@ -187,7 +186,6 @@ void RamSequence::edit(bool show)
 
 void RamSequence::construct()
 {
-    m_existingObjects[m_uuid] = this;
     m_icon = ":/icons/sequence";
     m_editRole = ProjectAdmin;
 
@@ -53,7 +53,6 @@ public slots:
     virtual void edit(bool show = true) override;
 
 protected:
-    static QHash<QString, RamSequence*> m_existingObjects;
     RamSequence(QString uuid);
     virtual QString folderPath() const override { return ""; };
 
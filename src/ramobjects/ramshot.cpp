@@ -5,18 +5,22 @@
 #include "ramproject.h"
 #include "ramsequence.h"
 #include "shoteditwidget.h"
+#include "ramobjectregistry.h"
+
+// FIELDS //
+
+const RamField<QString> RamShot::Fields::sequence = {"sequence", "none"};
+const RamField<double> RamShot::Fields::duration = {"duration", 5.0};
 
 // STATIC //
 
 QFrame *RamShot::ui_editWidget = nullptr;
 
-QHash<QString, RamShot*> RamShot::m_existingObjects = QHash<QString, RamShot*>();
-
 RamShot *RamShot::get(QString uuid)
 {
     if (!checkUuid(uuid, Shot)) return nullptr;
 
-    RamShot *s = m_existingObjects.value(uuid);
+    RamShot *s = RamObjectRegistry::get<RamShot>(uuid, Shot);
     if (s) return s;
 
     // Finally return a new instance
@@ -37,7 +41,7 @@ RamShot::RamShot(QString shortName, QString name, RamSequence *sequence):
 {
     Q_ASSERT_X(sequence, "RamAsset(shortname, name, assetgroup)", "Sequence can't be null!");
     construct();
-    insertData("sequence", sequence->uuid() );
+    setField(Fields::sequence, sequence->uuid());
     // Set the order: at the end of the current project
     RamProject *proj = sequence->project();
     insertData("order", proj->shots()->rowCount());
@@ -65,22 +69,22 @@ RamShot::RamShot(QString uuid):
 
 RamSequence *RamShot::sequence() const
 {
-    return RamSequence::get( getData("sequence").toString("none") );
+    return RamSequence::get( field(Fields::sequence) );
 }
 
 void RamShot::setSequence(RamObject *sequence)
 {
-    insertData("sequence", sequence->uuid() );
+    setField(Fields::sequence, sequence->uuid());
 }
 
 qreal RamShot::duration() const
 {
-    return getData("duration").toDouble(5);
+    return field(Fields::duration);
 }
 
 void RamShot::setDuration(const qreal &duration)
 {
-    insertData("duration", duration);
+    setField(Fields::duration, static_cast<double>(duration));
 }
 
 RamObjectModel *RamShot::assets() const
@@ -95,7 +99,7 @@ RamAsset *RamShot::assetAt(int row) const
 
 QString RamShot::filterUuid() const
 {
-    return getData("sequence").toString();
+    return data().value(Fields::sequence.key).toString();
 }
 
 QString RamShot::details() const
@@ -166,7 +170,6 @@ QString RamShot::folderPath() const
 
 void RamShot::construct()
 {
-    m_existingObjects[m_uuid] = this;
     m_icon = ":/icons/shot";
     m_editRole = ProjectAdmin;
     m_assets = createModel(RamObject::Asset, "assets");
@@ -12,6 +12,16 @@ class RamShot : public RamAbstractItem
     Q_OBJECT
 public:
 
+    // FIELDS //
+
+    /**
+     * @brief The Fields struct declares the fields of the shot data
+     */
+    struct Fields {
+        static const RamField<QString> sequence;
+        static const RamField<double> duration;
+    };
+
     // STATIC METHODS //
 
     static RamShot *get(QString uuid);
@@ -47,7 +57,6 @@ public slots:
     virtual void edit(bool show = true) override;
 
 protected:
-    static QHash<QString, RamShot*> m_existingObjects;
     virtual QString folderPath() const override;
     RamShot(QString uuid);
 
@@ -1,18 +1,17 @@
 #include "ramstate.h"
 
 #include "stateeditwidget.h"
+#include "ramobjectregistry.h"
 
 // STATIC //
 
 QFrame *RamState::ui_editWidget = nullptr;
 
-QHash<QString, RamState*> RamState::m_existingObjects = QHash<QString, RamState*>();
-
 RamState *RamState::get(QString uuid )
 {
     if (!checkUuid(uuid, State)) return nullptr;
 
-    RamState *s = m_existingObjects.value(uuid);
+    RamState *s = RamObjectRegistry::get<RamState>(uuid, State);
     if (s) return s;
 
     // Finally return a new instance
@@ -78,7 +77,6 @@ void RamState::edit(bool show)
 
 void RamState::construct()
 {
-    m_existingObjects[m_uuid] = this;
     m_icon = ":/icons/state-l";
     m_editRole = Admin;
 }
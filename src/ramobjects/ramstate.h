@@ -27,7 +27,6 @@ public slots:
     virtual void edit(bool show = true) override;
 
 protected:
-    static QHash<QString, RamState*> m_existingObjects;
     RamState(QString uuid);
     virtual QString folderPath() const override { return ""; };
 
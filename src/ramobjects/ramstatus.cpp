@@ -7,18 +7,36 @@
 #include "statuseditwidget.h"
 #include "ramses.h"
 #include "ramuuid.h"
+#include "ramobjectregistry.h"
+
+// FIELDS //
+
+const RamField<QString> RamStatus::Fields::user = {"user", "none"};
+const RamField<QString> RamStatus::Fields::item = {"item", "none"};
+const RamField<QString> RamStatus::Fields::itemType = {"itemType", "asset"};
+const RamField<QString> RamStatus::Fields::step = {"step", "none"};
+const RamField<QString> RamStatus::Fields::state = {"state", "none"};
+const RamField<int> RamStatus::Fields::completionRatio = {"completionRatio", 50};
+const RamField<int> RamStatus::Fields::version = {"version", 0};
+const RamField<QDateTime> RamStatus::Fields::date = {"date", QDateTime()};
+const RamField<bool> RamStatus::Fields::useDueDate = {"useDueDate", false};
+const RamField<QDate> RamStatus::Fields::dueDate = {"dueDate", QDate()};
+const RamField<int> RamStatus::Fields::priority = {"priority", RamStatus::NoPriority};
+const RamField<bool> RamStatus::Fields::published = {"published", false};
+const RamField<QString> RamStatus::Fields::assignedUser = {"assignedUser", "none"};
+const RamField<QString> RamStatus::Fields::difficulty = {"difficulty", "medium"};
+const RamField<double> RamStatus::Fields::goal = {"goal", 0.0};
+const RamField<bool> RamStatus::Fields::useAutoEstimation = {"useAutoEstimation", true};
 
 // PROTECTED //
 
 QFrame *RamStatus::ui_editWidget = nullptr;
 
-QHash<QString, RamStatus*> RamStatus::m_existingObjects = QHash<QString, RamStatus*>();
-
 RamStatus *RamStatus::get(QString uuid)
 {
     if (!checkUuid(uuid, Status)) return nullptr;
 
-    RamStatus *s = m_existingObjects.value(uuid);
+    RamStatus *s = RamObjectRegistry::get<RamStatus>(uuid, Status);
     if (s) return s;
 
     // Finally return a new instance
@@ -78,23 +96,25 @@ RamStatus::RamStatus(RamUser *user, RamAbstractItem *item, RamStep *step, bool i
     m_step = step;
     m_item = item;
 
+    connectEvents();
+
     if (m_virtual) return;
 
     QJsonObject d = data();
 
-    if (user) d.insert("user", user->uuid());
-    else d.insert("user", "none");
+    if (user) Fields::user.write(d, user->uuid());
+    else Fields::user.write(d, "none");
 
-    d.insert("item", item->uuid());
-    if (item->objectType() == RamObject::Shot) d.insert("itemType", "shot");
-    else if (item->objectType() == RamObject::Asset) d.insert("itemType", "asset");
-    else d.insert("itemType", "item");
+    Fields::item.write(d, item->uuid());
+    if (item->objectType() == RamObject::Shot) Fields::itemType.write(d, "shot");
+    else if (item->objectType() == RamObject::Asset) Fields::itemType.write(d, "asset");
+    else Fields::itemType.write(d, "item");
 
-    d.insert("step", step->uuid());
+    Fields::step.write(d, step->uuid());
 
     RamState *state = Ramses::instance()->noState();
-    d.insert("state", state->uuid());
-    d.insert("completionRatio", 0);
+    Fields::state.write(d, state->uuid());
+    Fields::completionRatio.write(d, 0);
 
     setData(d);
 
@@ -108,8 +128,8 @@ RamStatus::RamStatus(QString uuid):
 
     QJsonObject d = data();
 
-    QString itemType = d.value("itemType").toString("asset");
-    QString itemUuid = d.value("item").toString("none");
+    QString itemType = Fields::itemType.read(d);
+    QString itemUuid = Fields::item.read(d);
 
     if (itemType == "shot") {
         m_item = RamShot::get( itemUuid );
@@ -118,7 +138,7 @@ RamStatus::RamStatus(QString uuid):
         m_item = RamAsset::get( itemUuid );
     }
 
-    m_step = RamStep::get( d.value("step").toString("none") );
+    m_step = RamStep::get( Fields::step.read(d) );
 
     if (m_step && m_item) connectEvents();
     else invalidate();
@@ -126,7 +146,7 @@ RamStatus::RamStatus(QString uuid):
 
 RamUser *RamStatus::modifiedBy() const
 {
-    QString userUuid( getData("user").toString("none") );
+    QString userUuid( field(Fields::user) );
     RamUser *u = RamUser::get( userUuid );
     if (u) return u;
     return Ramses::instance()->ramsesUser();
@@ -140,8 +160,8 @@ void RamStatus::setModifiedBy(RamUser *user)
     RamUser *prevUser = modifiedBy();
     if (prevUser->is(user)) return;
 
-    if (!user) insertData("user", "none");
-    else insertData("user", user->uuid());
+    if (!user) setField(Fields::user, QStringLiteral("none"));
+    else setField(Fields::user, user->uuid());
     // Create history
     LocalDataInterface::instance()->createObject(
                 RamUuid::generateUuidString(this->shortName() + this->name()),
@@ -157,7 +177,7 @@ RamStep *RamStatus::step() const
 
 QString RamStatus::stepUuid() const
 {
-    return getData("step").toString();
+    return field(Fields::step);
 }
 
 RamAbstractItem *RamStatus::item() const
@@ -167,7 +187,7 @@ RamAbstractItem *RamStatus::item() const
 
 QString RamStatus::itemUuid() const
 {
-    return getData("item").toString();
+    return field(Fields::item);
 }
 
 bool RamStatus::isNoState() const
@@ -183,20 +203,21 @@ bool RamStatus::isDisabled() const
 
 int RamStatus::completionRatio() const
 {
-    return getData("completionRatio").toInt(50);
+    return field(Fields::completionRatio);
 }
 
 void RamStatus::setCompletionRatio(int completionRatio)
 {
     QJsonObject d = data();
-    d.insert("completionRatio", completionRatio);
+    Fields::completionRatio.write(d, completionRatio);
     updateData(&d);
+    notifyFieldChanged(Fields::completionRatio.key);
 }
 
 RamState *RamStatus::state() const
 {
     if (m_virtual) return Ramses::instance()->noState();
-    return RamState::get( getData("state").toString("none") );
+    return RamState::get( field(Fields::state) );
 }
 
 void RamStatus::setState(RamState *newState)
@@ -206,9 +227,11 @@ void RamStatus::setState(RamState *newState)
 
     QJsonObject d = data();
 
-    d.insert("state", newState->uuid());
-    d.insert( "completionRatio", newState->completionRatio() );
+    Fields::state.write(d, newState->uuid());
+    Fields::completionRatio.write(d, newState->completionRatio());
     updateData(&d);
+    notifyFieldChanged(Fields::state.key);
+    notifyFieldChanged(Fields::completionRatio.key);
 
     connect(newState, SIGNAL(removed(RamObject*)), this, SLOT(stateRemoved()));
 }
@@ -216,59 +239,61 @@ void RamStatus::setState(RamState *newState)
 int RamStatus::version() const
 {
     if (m_virtual) return 0;
-    return getData("version").toInt();
+    return field(Fields::version);
 }
 
 void RamStatus::setVersion(int version)
 {
     QJsonObject d = data();
-    d.insert("version", version);
+    Fields::version.write(d, version);
     updateData(&d);
+    notifyFieldChanged(Fields::version.key);
 }
 
 QDateTime RamStatus::date() const
 {
     if (m_virtual) return QDateTime::currentDateTime();
-    return QDateTime::fromString( getData("date").toString(), "yyyy-MM-dd hh:mm:ss");
+    return field(Fields::date);
 }
 
 void RamStatus::setDate(const QDateTime &date)
 {
-    insertData("date", date.toString("yyyy-MM-dd hh:mm:ss"));
+    setField(Fields::date, date);
 }
 
 bool RamStatus::useDueDate() const
 {
     if (m_virtual) return false;
-    return getData("useDueDate").toBool(false);
+    return field(Fields::useDueDate);
 }
 
 void RamStatus::setUseDueDate(bool use)
 {
-    insertData("useDueDate", use);
+    setField(Fields::useDueDate, use);
 }
 
 QDate RamStatus::dueDate() const
 {
-    QString defaultDate = QDate::currentDate().toString("yyyy-MM-dd");
-    if (m_virtual) return QDate::fromString(defaultDate, "yyyy-MM-dd");
-    return QDate::fromString( getData("dueDate").toString(defaultDate), "yyyy-MM-dd");
+    if (m_virtual) return QDate::currentDate();
+    // Defaults to today
+    if (!data().contains(Fields::dueDate.key)) return QDate::currentDate();
+    return field(Fields::dueDate);
 }
 
 void RamStatus::setDueDate(const QDate &date)
 {
-    insertData("dueDate", date.toString("yyyy-MM-dd"));
+    setField(Fields::dueDate, date);
     setUseDueDate(true);
 }
 
 RamStatus::Priority RamStatus::priority() const
 {
-    return static_cast<Priority>(getData("priority").toInt(NoPriority));
+    return static_cast<Priority>( field(Fields::priority) );
 }
 
 void RamStatus::setPriority(Priority p)
 {
-    insertData("priority", p);
+    setField(Fields::priority, static_cast<int>(p));
 }
 
 qreal RamStatus::lateness() const
@@ -285,20 +310,21 @@ qreal RamStatus::lateness() const
 bool RamStatus::isPublished() const
 {
     if (m_virtual) return false;
-    return getData("published").toBool();
+    return field(Fields::published);
 }
 
 void RamStatus::setPublished(bool published)
 {
     QJsonObject d = data();
-    d.insert("published", published);
+    Fields::published.write(d, published);
     updateData(&d);
+    notifyFieldChanged(Fields::published.key);
 }
 
 RamUser *RamStatus::assignedUser() const
 {
     if (m_virtual) return nullptr;
-    return RamUser::get( getData("assignedUser").toString("none") );
+    return RamUser::get( field(Fields::assignedUser) );
 }
 
 void RamStatus::assignUser(RamObject *user)
@@ -306,18 +332,19 @@ void RamStatus::assignUser(RamObject *user)
     QJsonObject d = data();
     RamUser *currentUser = assignedUser();
     if (currentUser) disconnect(assignedUser(), nullptr, this, nullptr);
-    if (!user) d.insert("assignedUser", "none");
+    if (!user) Fields::assignedUser.write(d, "none");
     else {
-        d.insert("assignedUser", user->uuid());
+        Fields::assignedUser.write(d, user->uuid());
         connect(user, SIGNAL(removed(RamObject*)), this, SLOT(assignedUserRemoved()));
     }
     updateData(&d);
+    notifyFieldChanged(Fields::assignedUser.key);
 }
 
 RamStatus::Difficulty RamStatus::difficulty() const
 {
     if (m_virtual) return Medium;
-    QString dffclt = getData("difficulty").toString("medium");
+    QString dffclt = field(Fields::difficulty);
     if (dffclt == "veryEasy") return VeryEasy;
     else if (dffclt == "easy") return Easy;
     else if (dffclt == "medium") return Medium;
@@ -331,23 +358,24 @@ void RamStatus::setDifficulty(Difficulty newDifficulty)
     QJsonObject d = data();
     switch(newDifficulty) {
     case VeryEasy:
-        d.insert("difficulty", "veryEasy");
+        Fields::difficulty.write(d, "veryEasy");
         break;
     case Easy:
-        d.insert("difficulty", "easy");
+        Fields::difficulty.write(d, "easy");
         break;
     case Medium:
-        d.insert("difficulty", "medium");
+        Fields::difficulty.write(d, "medium");
         break;
     case Hard:
-        d.insert("difficulty", "hard");
+        Fields::difficulty.write(d, "hard");
         break;
     case VeryHard:
-        d.insert("difficulty", "veryHard");
+        Fields::difficulty.write(d, "veryHard");
         break;
     }
 
     updateData(&d);
+    notifyFieldChanged(Fields::difficulty.key);
 }
 
 float RamStatus::goal() const
@@ -357,7 +385,7 @@ float RamStatus::goal() const
     RamState *noState = Ramses::instance()->noState();
     if (noState->is(state())) return 0.0;
 
-    float g = getData("goal").toDouble();
+    float g = field(Fields::goal);
 
     return g;
 }
@@ -365,8 +393,9 @@ float RamStatus::goal() const
 void RamStatus::setGoal(float newGoal)
 {
     QJsonObject d = data();
-    d.insert("goal", newGoal);
+    Fields::goal.write(d, newGoal);
     updateData(&d);
+    notifyFieldChanged(Fields::goal.key);
 }
 
 float RamStatus::estimation() const
@@ -446,17 +475,18 @@ bool RamStatus::useAutoEstimation() const
     RamState *noState = Ramses::instance()->noState();
     if (noState->is(state())) return true;
 
-    return getData("useAutoEstimation").toBool(true);
+    return field(Fields::useAutoEstimation);
 }
 
 void RamStatus::setUseAutoEstimation(bool newAutoEstimation)
 {
     QJsonObject d = data();
 
-    d.insert("useAutoEstimation", newAutoEstimation);
-    if (!newAutoEstimation && d.value("goal").toDouble() <= 0) d.insert("goal", estimation());
+    Fields::useAutoEstimation.write(d, newAutoEstimation);
+    if (!newAutoEstimation && Fields::goal.read(d) <= 0) Fields::goal.write(d, estimation());
 
     updateData(&d);
+    notifyFieldChanged(Fields::useAutoEstimation.key);
 }
 
 RamWorkingFolder RamStatus::workingFolder() const
@@ -751,7 +781,6 @@ void RamStatus::assignedUserRemoved()
 
 void RamStatus::construct()
 {
-    m_existingObjects[m_uuid] = this;
     m_icon = ":/icons/status";
     m_editRole = Lead;
 }
@@ -760,15 +789,16 @@ void RamStatus::connectEvents()
 {
     if (m_item) connect(m_item, &RamAbstractItem::removed, this, &RamStatus::remove);
     if( m_step) connect(m_step, &RamStep::removed, this, &RamStatus::remove);
+    // Let the models update only the cell of this status
+    if (m_item) connect(this, &RamObject::fieldChanged, m_item, &RamAbstractItem::statusFieldChanged);
 }
 
 void RamStatus::updateData(QJsonObject *d)
 {
-    d->insert("date", QDateTime::currentDateTimeUtc().toString("yyyy-MM-dd hh:mm:ss"));
+    Fields::date.write(*d, QDateTime::currentDateTimeUtc());
 
     setData(*d);
 
-    // Emit for the models
-    RamAbstractItem *item = this->item();
-    if (item) item->emitDataChanged();
+    // Updates the models through the item, after the edit session if any
+    notifyFieldChanged(Fields::date.key);
 }
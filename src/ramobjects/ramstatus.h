@@ -34,6 +34,30 @@ public:
         HighPriority = 3,
     };
 
+    // FIELDS //
+
+    /**
+     * @brief The Fields struct declares the fields of the status data
+     */
+    struct Fields {
+        static const RamField<QString> user;
+        static const RamField<QString> item;
+        static const RamField<QString> itemType;
+        static const RamField<QString> step;
+        static const RamField<QString> state;
+        static const RamField<int> completionRatio;
+        static const RamField<int> version;
+        static const RamField<QDateTime> date;
+        static const RamField<bool> useDueDate;
+        static const RamField<QDate> dueDate;
+        static const RamField<int> priority;
+        static const RamField<bool> published;
+        static const RamField<QString> assignedUser;
+        static const RamField<QString> difficulty;
+        static const RamField<double> goal;
+        static const RamField<bool> useAutoEstimation;
+    };
+
     // STATIC METHODS //
 
     static RamStatus *get(QString uuid);
@@ -120,7 +144,6 @@ public slots:
     virtual void edit(bool show = true) override;
 
 protected:
-    static QHash<QString, RamStatus*> m_existingObjects;
     RamStatus(QString uuid);
     virtual QString folderPath() const override;
 
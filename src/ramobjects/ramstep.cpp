@@ -11,18 +11,17 @@
 #include "stepeditwidget.h"
 #include "ramshot.h"
 #include "ramses.h"
+#include "ramobjectregistry.h"
 
 // STATIC //
 
 QFrame *RamStep::ui_editWidget = nullptr;
 
-QHash<QString, RamStep*> RamStep::m_existingObjects = QHash<QString, RamStep*>();
-
 RamStep *RamStep::get(QString uuid, bool includeRemoved)
 {
     if (!checkUuid(uuid, Step)) return nullptr;
 
-    RamStep *s = m_existingObjects.value(uuid);
+    RamStep *s = RamObjectRegistry::get<RamStep>(uuid, Step);
 
     if (!s) s = new RamStep(uuid);
 
@@ -432,7 +431,6 @@ QString RamStep::folderPath() const
 
 void RamStep::construct()
 {
-    m_existingObjects[m_uuid] = this;
     m_objectType = Step;
     m_editRole = RamObject::ProjectAdmin;
 }
@@ -69,7 +69,6 @@ public slots:
     virtual void edit(bool show = true) override;
 
 protected:
-    static QHash<QString, RamStep*> m_existingObjects;
     RamStep(QString uuid);
     virtual QString folderPath() const override;
 
@@ -1,18 +1,17 @@
 #include "ramtemplateassetgroup.h"
 
 #include "templateassetgroupeditwidget.h"
+#include "ramobjectregistry.h"
 
 // STATIC //
 
 QFrame *RamTemplateAssetGroup::ui_editWidget = nullptr;
 
-QHash<QString, RamTemplateAssetGroup*> RamTemplateAssetGroup::m_existingObjects = QHash<QString, RamTemplateAssetGroup*>();
-
 RamTemplateAssetGroup *RamTemplateAssetGroup::get(QString uuid)
 {
     if (!checkUuid(uuid, TemplateAssetGroup)) return nullptr;
 
-    RamTemplateAssetGroup *t = m_existingObjects.value(uuid);
+    RamTemplateAssetGroup *t = RamObjectRegistry::get<RamTemplateAssetGroup>(uuid, TemplateAssetGroup);
     if (t) return t;
 
     // Finally return a new instance
@@ -54,7 +53,6 @@ void RamTemplateAssetGroup::edit(bool show)
 
 void RamTemplateAssetGroup::construct()
 {
-    m_existingObjects[m_uuid] = this;
     m_icon = ":/icons/asset-group";
     m_editRole = Admin;
 }
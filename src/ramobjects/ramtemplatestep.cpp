@@ -1,13 +1,12 @@
 #include "ramtemplatestep.h"
 
 #include "templatestepeditwidget.h"
+#include "ramobjectregistry.h"
 
 // STATIC //
 
 QFrame *RamTemplateStep::ui_editWidget = nullptr;
 
-QHash<QString, RamTemplateStep*> RamTemplateStep::m_existingObjects = QHash<QString, RamTemplateStep*>();
-
 QMetaEnum const RamTemplateStep::m_stepTypeMeta = QMetaEnum::fromType<RamTemplateStep::Type>();
 
 const QString RamTemplateStep::stepTypeName(Type type)
@@ -28,7 +27,7 @@ RamTemplateStep *RamTemplateStep::get(QString uuid)
 {
     if (!checkUuid(uuid, TemplateStep)) return nullptr;
 
-    RamTemplateStep *t = m_existingObjects.value(uuid);
+    RamTemplateStep *t = RamObjectRegistry::get<RamTemplateStep>(uuid, TemplateStep);
     if (t) return t;
 
     // Finally return a new instance
@@ -224,7 +223,6 @@ void RamTemplateStep::setEstimationMethod(const EstimationMethod &newEstimationM
 
 void RamTemplateStep::construct()
 {
-    m_existingObjects[m_uuid] = this;
     m_icon = ":/icons/step";
     m_editRole = Admin;
 
@@ -5,18 +5,17 @@
 #include "ramstep.h"
 #include "usereditwidget.h"
 #include "ramdatainterface/dbinterface.h"
+#include "ramobjectregistry.h"
 
 // STATIC //
 
 QFrame *RamUser::ui_editWidget = nullptr;
 
-QHash<QString, RamUser*> RamUser::m_existingObjects = QHash<QString, RamUser*>();
-
 RamUser *RamUser::get(QString uuid )
 {
     if (!checkUuid(uuid, User)) return nullptr;
 
-    RamUser *u = m_existingObjects.value(uuid);
+    RamUser *u = RamObjectRegistry::get<RamUser>(uuid, User);
     if (u) return u;
 
     // Finally return a new instance
@@ -178,7 +177,6 @@ QString RamUser::folderPath() const
 
 void RamUser::construct()
 {
-    m_existingObjects[m_uuid] = this;
     m_icon = ":/icons/user";
     m_editRole = Admin;
     //m_schedule = createModel(RamObject::ScheduleEntry, "schedule");
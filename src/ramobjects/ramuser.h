@@ -40,7 +40,6 @@ public slots:
     virtual void edit(bool show = true) override;
 
 protected:
-    static QHash<QString, RamUser*> m_existingObjects;
     RamUser(QString uuid);
     virtual QString folderPath() const override;
 
@@ -0,0 +1,7 @@
+include(../tests.pri)
+
+QT += sql
+
+TARGET = tst_localdataqueries
+
+SOURCES += tst_localdataqueries.cpp
@@ -0,0 +1,167 @@
+#include <QtTest>
+#include <QtSql>
+
+// LocalDataInterface needs the whole application,
+// these benchmarks run the statements of objectData() and setObjectData() on their own,
+// built with QString::arg() as before, and prepared once with bound values as now.
+class BenchLocalDataQueries : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void objectDataArg();
+    void objectDataPrepared();
+    void setObjectDataArg();
+    void setObjectDataPrepared();
+
+private:
+    // Like a project with 40k statuses
+    static const int ROW_COUNT = 40000;
+    // Rows read or written in each benchmark iteration
+    static const int CALL_COUNT = 1000;
+
+    QSqlQuery query(const QString &q);
+    QString modifiedStr() const;
+
+    QTemporaryDir m_dir;
+    QString m_connectionName = "benchlocaldata";
+    QString m_table = "RamStatus";
+    QStringList m_uuids;
+    QString m_data;
+};
+
+void BenchLocalDataQueries::initTestCase()
+{
+    QVERIFY(m_dir.isValid());
+
+    QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE", m_connectionName);
+    db.setDatabaseName(m_dir.filePath("bench.ramses"));
+    QVERIFY(db.open());
+
+    // Same table and options as the local data
+    query( "PRAGMA journal_mode = WAL;" );
+    query( "PRAGMA synchronous = NORMAL;" );
+    query( QString("CREATE TABLE \"%1\" ( "
+                   "\"id\"	INTEGER NOT NULL UNIQUE, "
+                   "\"uuid\"	TEXT NOT NULL UNIQUE, "
+                   "\"data\"	TEXT NOT NULL DEFAULT '{}', "
+                   "\"modified\"	timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP, "
+                   "\"removed\"	INTEGER NOT NULL DEFAULT 0, "
+                   "PRIMARY KEY(\"id\" AUTOINCREMENT) );").arg(m_table) );
+
+    m_data = "{\"comment\":\"It's a status\",\"completionRatio\":50,\"state\":\"6f9619ff-8b86-d011-b42d-00c04fc964ff\","
+             "\"step\":\"3b241101-e2bb-4255-8caf-4136c566a962\",\"item\":\"a8098c1a-f86e-11da-bd1a-00112444be1e\"}";
+
+    QVERIFY(db.transaction());
+    QSqlQuery qry(db);
+    QVERIFY(qry.prepare( QString("INSERT INTO \"%1\" (uuid, data, modified) VALUES (:uuid, :data, :modified);").arg(m_table) ));
+    for (int i = 0; i < ROW_COUNT; i++)
+    {
+        QString uuid = QUuid::createUuid().toString(QUuid::WithoutBraces);
+        qry.bindValue(":uuid", uuid);
+        qry.bindValue(":data", m_data);
+        qry.bindValue(":modified", modifiedStr());
+        QVERIFY(qry.exec());
+        if (i % (ROW_COUNT / CALL_COUNT) == 0) m_uuids << uuid;
+    }
+    QVERIFY(db.commit());
+}
+
+void BenchLocalDataQueries::cleanupTestCase()
+{
+    QSqlDatabase::database(m_connectionName).close();
+    QSqlDatabase::removeDatabase(m_connectionName);
+}
+
+void BenchLocalDataQueries::objectDataArg()
+{
+    QBENCHMARK {
+        for (const QString &uuid: qAsConst(m_uuids))
+        {
+            QString q = "SELECT data FROM %1 WHERE uuid = '%2';";
+            QSqlQuery qry = query( q.arg(m_table, uuid) );
+            QVERIFY(qry.first());
+            QCOMPARE(qry.value(0).toString(), m_data);
+        }
+    }
+}
+
+void BenchLocalDataQueries::objectDataPrepared()
+{
+    QSqlQuery qry( QSqlDatabase::database(m_connectionName) );
+    qry.setForwardOnly(true);
+    QVERIFY(qry.prepare( QString("SELECT data FROM \"%1\" WHERE uuid = :uuid;").arg(m_table) ));
+
+    QBENCHMARK {
+        for (const QString &uuid: qAsConst(m_uuids))
+        {
+            qry.bindValue(":uuid", uuid);
+            QVERIFY(qry.exec());
+            QVERIFY(qry.first());
+            QCOMPARE(qry.value(0).toString(), m_data);
+            qry.finish();
+        }
+    }
+}
+
+void BenchLocalDataQueries::setObjectDataArg()
+{
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+
+    QBENCHMARK {
+        db.transaction();
+        for (const QString &uuid: qAsConst(m_uuids))
+        {
+            QString newData = m_data;
+            newData.replace("'", "''");
+
+            QString q = "INSERT INTO %1 (data, modified, uuid) "
+                        "VALUES ( '%2', '%3', '%4') "
+                        "ON CONFLICT(uuid) DO UPDATE "
+                        "SET data=excluded.data, modified=excluded.modified ;";
+            query( q.arg(m_table, newData, modifiedStr(), uuid) );
+        }
+        db.commit();
+    }
+}
+
+void BenchLocalDataQueries::setObjectDataPrepared()
+{
+    QSqlDatabase db = QSqlDatabase::database(m_connectionName);
+    QSqlQuery qry(db);
+    QVERIFY(qry.prepare( QString("INSERT INTO \"%1\" (data, modified, uuid) "
+                                 "VALUES (:data, :modified, :uuid) "
+                                 "ON CONFLICT(uuid) DO UPDATE "
+                                 "SET data=excluded.data, modified=excluded.modified ;").arg(m_table) ));
+
+    QBENCHMARK {
+        db.transaction();
+        for (const QString &uuid: qAsConst(m_uuids))
+        {
+            qry.bindValue(":data", m_data);
+            qry.bindValue(":modified", modifiedStr());
+            qry.bindValue(":uuid", uuid);
+            QVERIFY(qry.exec());
+        }
+        db.commit();
+    }
+}
+
+QSqlQuery BenchLocalDataQueries::query(const QString &q)
+{
+    QSqlQuery qry( QSqlDatabase::database(m_connectionName) );
+    if (!qry.exec(q)) qWarning() << qry.lastError().databaseText();
+    return qry;
+}
+
+QString BenchLocalDataQueries::modifiedStr() const
+{
+    return QDateTime::currentDateTimeUtc().toString("yyyy-MM-dd hh:mm:ss");
+}
+
+QTEST_GUILESS_MAIN(BenchLocalDataQueries)
+
+#include "tst_localdataqueries.moc"
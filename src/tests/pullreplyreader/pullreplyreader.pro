@@ -0,0 +1,8 @@
+include(../tests.pri)
+
+TARGET = tst_pullreplyreader
+
+SOURCES += tst_pullreplyreader.cpp \
+    $$SRC_DIR/ramdatainterface/pullreplyreader.cpp
+
+HEADERS += $$SRC_DIR/ramdatainterface/pullreplyreader.h
@@ -0,0 +1,196 @@
+#include <QtTest>
+
+#include "pullreplyreader.h"
+
+class TestPullReplyReader : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void wholeReply();
+    void byteByByte();
+    void everySplit();
+    void escapedStrings();
+    void envelope();
+    void takeRows();
+
+private:
+    static TableRow row(const QString &uuid, const QString &data, const QString &userName = "", int removed = 0);
+    // A pull reply, serialized by Qt like the server would
+    static QByteArray reply(const QVector<TableRow> &rows);
+    // Checks every field of the rows which have been read
+    static void checkRows(const QSet<TableRow> &rows, const QVector<TableRow> &expected);
+
+    QVector<TableRow> m_rows;
+    QByteArray m_reply;
+};
+
+TableRow TestPullReplyReader::row(const QString &uuid, const QString &data, const QString &userName, int removed)
+{
+    TableRow r;
+    r.uuid = uuid;
+    r.data = data;
+    r.userName = userName;
+    r.removed = removed;
+    r.modified = "2023-01-02 03:04:05";
+    return r;
+}
+
+QByteArray TestPullReplyReader::reply(const QVector<TableRow> &rows)
+{
+    QJsonArray rowsArray;
+    for (const TableRow &r: rows)
+    {
+        QJsonObject rowObj;
+        rowObj.insert("uuid", r.uuid);
+        rowObj.insert("data", r.data);
+        rowObj.insert("modified", r.modified);
+        rowObj.insert("removed", r.removed);
+        rowObj.insert("userName", r.userName);
+        rowsArray.append(rowObj);
+    }
+
+    QJsonObject content;
+    content.insert("table", "RamShot");
+    content.insert("page", 1);
+    content.insert("pageCount", 1);
+    content.insert("rows", rowsArray);
+
+    // Another "rows" array, which is not the one to read
+    QJsonObject log;
+    log.insert("level", "DEBUG");
+    log.insert("rows", QJsonArray({ "not", "rows" }));
+
+    QJsonObject replyObj;
+    replyObj.insert("query", "pull");
+    replyObj.insert("success", true);
+    replyObj.insert("message", "Rows [pulled]: {1}");
+    replyObj.insert("debug", QJsonArray({ log }));
+    replyObj.insert("content", content);
+
+    return QJsonDocument(replyObj).toJson(QJsonDocument::Indented);
+}
+
+void TestPullReplyReader::checkRows(const QSet<TableRow> &rows, const QVector<TableRow> &expected)
+{
+    QCOMPARE(rows.count(), expected.count());
+
+    // TableRow::operator== only compares the uuids
+    for (const TableRow &e: expected)
+    {
+        QSet<TableRow>::const_iterator it = rows.constFind(e);
+        QVERIFY2(it != rows.constEnd(), qPrintable(e.uuid));
+        QCOMPARE(it->data, e.data);
+        QCOMPARE(it->modified, e.modified);
+        QCOMPARE(it->removed, e.removed);
+        QCOMPARE(it->userName, e.userName);
+    }
+}
+
+void TestPullReplyReader::initTestCase()
+{
+    m_rows << row("6f9619ff-8b86-d011-b42d-00c04fc964ff", "{\"name\":\"Shot 1\",\"duration\":2.5}", "duduf");
+    // Brackets, braces, commas and quotes in the strings
+    m_rows << row("3b241101-e2bb-4255-8caf-4136c566a962", "{\"comment\":\"] }, { [\\\"rows\\\": [\"}", "", 1);
+    // Backslashes, the last one just before the closing quote
+    m_rows << row("a8098c1a-f86e-11da-bd1a-00112444be1e", "{\"path\":\"C:\\\\shots\\\\\"}", "back\\slash\\");
+    m_rows << row("b8098c1a-f86e-11da-bd1a-00112444be1e", QString::fromUtf8("{\"comment\":\"Déjà vu ✓\"}"), QString::fromUtf8("Léa"));
+    m_rows << row("c8098c1a-f86e-11da-bd1a-00112444be1e", "", "");
+
+    m_reply = reply(m_rows);
+}
+
+void TestPullReplyReader::wholeReply()
+{
+    PullReplyReader reader;
+    reader.addData(m_reply);
+    checkRows(reader.takeRows(), m_rows);
+}
+
+void TestPullReplyReader::byteByByte()
+{
+    PullReplyReader reader;
+    for (int i = 0; i < m_reply.size(); i++) reader.addData(m_reply.mid(i, 1));
+    checkRows(reader.takeRows(), m_rows);
+}
+
+void TestPullReplyReader::everySplit()
+{
+    // A row, a string, an escape sequence... may be split anywhere
+    for (int i = 1; i < m_reply.size(); i++)
+    {
+        PullReplyReader reader;
+        reader.addData(m_reply.left(i));
+        reader.addData(m_reply.mid(i));
+        checkRows(reader.takeRows(), m_rows);
+    }
+}
+
+void TestPullReplyReader::escapedStrings()
+{
+    // Written by hand, with escapes Qt doesn't write itself
+    const QByteArray data = R"({"query":"pull","content":{"rows":[)"
+                            R"({"uuid":"a\"]","data":"{\"x\":\"]}\\\\\"}","modified":"2023-01-02 03:04:05","removed":0,"userName":"L\u00e9a\/\t"},)"
+                            R"( {"uuid":"b","data":"[\"{\"]","modified":"2023-01-02 03:04:05","removed":1,"userName":""})"
+                            R"(]},"success":true})";
+
+    QVector<TableRow> expected;
+    expected << row("a\"]", "{\"x\":\"]}\\\\\"}", QString::fromUtf8("Léa/\t"));
+    expected << row("b", "[\"{\"]", "", 1);
+
+    for (int i = 1; i < data.size(); i++)
+    {
+        PullReplyReader reader;
+        reader.addData(data.left(i));
+        reader.addData(data.mid(i));
+        checkRows(reader.takeRows(), expected);
+    }
+}
+
+void TestPullReplyReader::envelope()
+{
+    PullReplyReader reader;
+    for (int i = 0; i < m_reply.size(); i += 7) reader.addData(m_reply.mid(i, 7));
+
+    QJsonParseError error;
+    QJsonDocument doc = QJsonDocument::fromJson(reader.envelope(), &error);
+    QCOMPARE(error.error, QJsonParseError::NoError);
+
+    // Everything but the rows
+    QJsonObject replyObj = doc.object();
+    QCOMPARE(replyObj.value("query").toString(), QString("pull"));
+    QCOMPARE(replyObj.value("success").toBool(), true);
+    QCOMPARE(replyObj.value("message").toString(), QString("Rows [pulled]: {1}"));
+    QCOMPARE(replyObj.value("debug").toArray().at(0).toObject().value("rows").toArray().count(), 2);
+
+    QJsonObject content = replyObj.value("content").toObject();
+    QCOMPARE(content.value("table").toString(), QString("RamShot"));
+    QCOMPARE(content.value("page").toInt(), 1);
+    QCOMPARE(content.value("pageCount").toInt(), 1);
+    QVERIFY(content.value("rows").isArray());
+    QVERIFY(content.value("rows").toArray().isEmpty());
+}
+
+void TestPullReplyReader::takeRows()
+{
+    // The rows are available as soon as they're complete
+    PullReplyReader reader;
+    int half = m_reply.indexOf(m_rows.at(2).uuid.toUtf8());
+    reader.addData(m_reply.left(half));
+    QSet<TableRow> first = reader.takeRows();
+    reader.addData(m_reply.mid(half));
+    QSet<TableRow> second = reader.takeRows();
+
+    QCOMPARE(first.count() + second.count(), m_rows.count());
+    QVERIFY(first.count() >= 2);
+    QVERIFY(reader.takeRows().isEmpty());
+
+    first.unite(second);
+    checkRows(first, m_rows);
+}
+
+QTEST_APPLESS_MAIN(TestPullReplyReader)
+
+#include "tst_pullreplyreader.moc"
@@ -0,0 +1,8 @@
+include(../tests.pri)
+
+TARGET = tst_tablerowcodec
+
+SOURCES += tst_tablerowcodec.cpp \
+    $$SRC_DIR/ramdatainterface/tablerowcodec.cpp
+
+HEADERS += $$SRC_DIR/ramdatainterface/tablerowcodec.h
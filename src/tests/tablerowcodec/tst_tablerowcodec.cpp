@@ -0,0 +1,133 @@
+#include <QtTest>
+
+#include "tablerowcodec.h"
+
+class TestTableRowCodec : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void roundTrip();
+    void emptyBatch();
+    void nonRfcUuids();
+    void nonStandardDates();
+    void largeUserDictionary();
+    void invalidData();
+
+private:
+    static TableRow row(const QString &uuid, const QString &modified, const QString &userName = "", const QString &data = "{}", int removed = 0);
+    // Encodes and decodes the rows, and checks every field survived
+    static void checkRoundTrip(const QVector<TableRow> &rows);
+};
+
+TableRow TestTableRowCodec::row(const QString &uuid, const QString &modified, const QString &userName, const QString &data, int removed)
+{
+    TableRow r;
+    r.uuid = uuid;
+    r.modified = modified;
+    r.userName = userName;
+    r.data = data;
+    r.removed = removed;
+    return r;
+}
+
+void TestTableRowCodec::checkRoundTrip(const QVector<TableRow> &rows)
+{
+    bool ok = false;
+    QVector<TableRow> decoded = TableRowCodec::decode( TableRowCodec::encode(rows), &ok );
+    QVERIFY(ok);
+    QCOMPARE(decoded.count(), rows.count());
+
+    // TableRow::operator== only compares the uuids
+    for (int i = 0; i < rows.count(); i++)
+    {
+        QCOMPARE(decoded.at(i).uuid, rows.at(i).uuid);
+        QCOMPARE(decoded.at(i).modified, rows.at(i).modified);
+        QCOMPARE(decoded.at(i).userName, rows.at(i).userName);
+        QCOMPARE(decoded.at(i).data, rows.at(i).data);
+        QCOMPARE(decoded.at(i).removed, rows.at(i).removed);
+    }
+}
+
+void TestTableRowCodec::roundTrip()
+{
+    QVector<TableRow> rows;
+    rows << row("6f9619ff-8b86-d011-b42d-00c04fc964ff", "2023-01-02 03:04:05", "duduf", "{\"name\":\"Shot 1\"}");
+    rows << row("3b241101-e2bb-4255-8caf-4136c566a962", "1970-01-01 00:00:00", "", "{}", 1);
+    rows << row("a8098c1a-f86e-11da-bd1a-00112444be1e", "2038-01-19 03:14:08", "duduf", QString::fromUtf8("{\"comment\":\"Déjà vu ✓\"}"));
+    checkRoundTrip(rows);
+}
+
+void TestTableRowCodec::emptyBatch()
+{
+    checkRoundTrip(QVector<TableRow>());
+}
+
+void TestTableRowCodec::nonRfcUuids()
+{
+    // One uuid which can't be stored as 16 bytes: all of them are kept as strings
+    QVector<TableRow> rows;
+    rows << row("6f9619ff-8b86-d011-b42d-00c04fc964ff", "2023-01-02 03:04:05");
+    rows << row("not-a-uuid", "2023-01-02 03:04:05");
+    // Valid, but it wouldn't be decoded the same (braces, upper case)
+    rows << row("{3b241101-e2bb-4255-8caf-4136c566a962}", "2023-01-02 03:04:05");
+    rows << row("A8098C1A-F86E-11DA-BD1A-00112444BE1E", "2023-01-02 03:04:05");
+    rows << row("", "2023-01-02 03:04:05");
+    checkRoundTrip(rows);
+}
+
+void TestTableRowCodec::nonStandardDates()
+{
+    // One date which can't be stored as epoch seconds: all of them are kept as strings
+    QVector<TableRow> rows;
+    rows << row("6f9619ff-8b86-d011-b42d-00c04fc964ff", "2023-01-02 03:04:05");
+    rows << row("3b241101-e2bb-4255-8caf-4136c566a962", "2023-01-02T03:04:05Z");
+    rows << row("a8098c1a-f86e-11da-bd1a-00112444be1e", "2023-13-45 25:61:61");
+    rows << row("b8098c1a-f86e-11da-bd1a-00112444be1e", "2023-01-02 03:04:05.123");
+    rows << row("c8098c1a-f86e-11da-bd1a-00112444be1e", "");
+    checkRoundTrip(rows);
+
+    // Dates before the epoch are still standard
+    QVector<TableRow> oldRows;
+    oldRows << row("6f9619ff-8b86-d011-b42d-00c04fc964ff", "1818-05-05 00:00:00");
+    checkRoundTrip(oldRows);
+}
+
+void TestTableRowCodec::largeUserDictionary()
+{
+    // More user names than a 16-bit index can address
+    const int count = 0xFFFF + 10;
+    QVector<TableRow> rows;
+    rows.reserve(count);
+    for (int i = 0; i < count; i++)
+    {
+        rows << row(QUuid::createUuid().toString(QUuid::WithoutBraces),
+                    "2023-01-02 03:04:05",
+                    QString("user%1").arg(i),
+                    QString("{\"i\":%1}").arg(i));
+    }
+    checkRoundTrip(rows);
+}
+
+void TestTableRowCodec::invalidData()
+{
+    bool ok = true;
+    QVERIFY(TableRowCodec::decode(QByteArray(), &ok).isEmpty());
+    QVERIFY(!ok);
+
+    ok = true;
+    QVERIFY(TableRowCodec::decode(QByteArray("{\"rows\":[]}"), &ok).isEmpty());
+    QVERIFY(!ok);
+
+    // Truncated batch
+    QVector<TableRow> rows;
+    rows << row("6f9619ff-8b86-d011-b42d-00c04fc964ff", "2023-01-02 03:04:05", "duduf", "{\"name\":\"Shot 1\"}");
+    QByteArray data = TableRowCodec::encode(rows);
+    ok = true;
+    QVERIFY(TableRowCodec::decode(data.left(data.size() - 4), &ok).isEmpty());
+    QVERIFY(!ok);
+}
+
+QTEST_APPLESS_MAIN(TestTableRowCodec)
+
+#include "tst_tablerowcodec.moc"
@@ -0,0 +1,16 @@
+QT += testlib network
+QT -= gui
+
+CONFIG += c++11 console testcase
+CONFIG -= app_bundle
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+# The sources under test are built with the test, not with the application
+SRC_DIR = $$PWD/..
+INCLUDEPATH += $$SRC_DIR \
+    $$SRC_DIR/ramdatainterface
+
+# Like the application, the sources rely on the precompiled header for the Qt includes
+PRECOMPILED_HEADER = $$PWD/tests_pch.h
+CONFIG += precompile_header
@@ -0,0 +1,7 @@
+# Unit tests and benchmarks of the classes which don't need the application to run.
+# Build and run with: qmake && make check
+TEMPLATE = subdirs
+
+SUBDIRS += tablerowcodec \
+    pullreplyreader \
+    localdataqueries
@@ -0,0 +1,5 @@
+#include <QtCore>
+#include <QNetworkRequest>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>